@@ -0,0 +1,138 @@
+#include "batch.h"
+#include "modem.h"
+#include <sndfile.h>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+struct BatchOptions {
+    Mode mode = Mode::AM;
+    float noise_level = 0.1f;
+    bool echo = false;
+    uint64_t seed = 1;
+    size_t block = 65536;
+    int oversample = 1;
+    int channel_fir = 0;
+    int post_fir = 0;
+    float rx_offset = 0.0f;
+};
+
+static void printUsage() {
+    std::cerr << "Usage: modulator --batch [--mode AM|FM|QAM] [--noise LEVEL] [--echo] [--oversample 1-8]\n"
+                 "                         [--channel-fir TAPS] [--post-fir TAPS] [--rx-offset HZ]\n"
+                 "                         [--seed N] [--block FRAMES]\n"
+                 "                         IN.wav OUT.wav [IN.wav OUT.wav ...]\n";
+}
+
+static bool processFile(const BatchOptions& opt, const char* in_path, const char* out_path) {
+    SF_INFO in_info = {0};
+    SNDFILE* in = sf_open(in_path, SFM_READ, &in_info);
+    if (!in) {
+        std::cerr << "Failed to open " << in_path << ": " << sf_strerror(nullptr) << "\n";
+        return false;
+    }
+    if (in_info.samplerate != SAMPLE_RATE) {
+        std::cerr << in_path << ": sample rate " << in_info.samplerate << " Hz, expected " << SAMPLE_RATE << " Hz\n";
+        sf_close(in);
+        return false;
+    }
+    SF_INFO out_info = {0};
+    out_info.channels = in_info.channels;
+    out_info.samplerate = SAMPLE_RATE;
+    out_info.format = SF_FORMAT_WAV | SF_FORMAT_FLOAT;
+    SNDFILE* out = sf_open(out_path, SFM_WRITE, &out_info);
+    if (!out) {
+        std::cerr << "Failed to open " << out_path << ": " << sf_strerror(nullptr) << "\n";
+        sf_close(in);
+        return false;
+    }
+
+    // Every file channel gets its own chain.
+    size_t channels = in_info.channels;
+    std::vector<ModemState> chains(channels);
+    for (size_t c = 0; c < channels; c++) {
+        chains[c].noise.seed(opt.seed + c);
+        chains[c].noise.setLevel(opt.noise_level);
+        setOversampling(chains[c], opt.oversample);
+        setChannelFilter(chains[c], opt.channel_fir);
+        setPostFilter(chains[c], opt.post_fir);
+        setReceiverOffset(chains[c], opt.rx_offset);
+    }
+    std::vector<float> frames(opt.block * channels);
+    std::vector<float> in_buf(opt.block), mod_buf(opt.block), demod_buf(opt.block);
+
+    auto start = std::chrono::steady_clock::now();
+    sf_count_t total = 0;
+    sf_count_t n;
+    while ((n = sf_readf_float(in, frames.data(), opt.block)) > 0) {
+        for (size_t c = 0; c < channels; c++) {
+            for (sf_count_t i = 0; i < n; i++) in_buf[i] = frames[i * channels + c];
+            processBlock(opt.mode, chains[c], in_buf.data(), mod_buf.data(), demod_buf.data(), n);
+            if (opt.echo) applyEcho(chains[c], demod_buf.data(), n);
+            for (sf_count_t i = 0; i < n; i++) frames[i * channels + c] = demod_buf[i];
+        }
+        sf_writef_float(out, frames.data(), n);
+        total += n;
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    sf_close(in);
+    sf_close(out);
+
+    double audio_seconds = static_cast<double>(total) / SAMPLE_RATE;
+    std::cout << in_path << " -> " << out_path << ": " << audio_seconds << " s of audio in " << elapsed << " s ("
+              << (elapsed > 0 ? audio_seconds / elapsed : 0.0) << "x real time)\n";
+    return true;
+}
+
+int runBatch(int argc, char* argv[]) {
+    BatchOptions opt;
+    std::vector<const char*> files;
+    for (int i = 0; i < argc; i++) {
+        const char* arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (strcmp(arg, "--mode") == 0 && has_value) {
+            const char* m = argv[++i];
+            if (strcmp(m, "AM") == 0) opt.mode = Mode::AM;
+            else if (strcmp(m, "FM") == 0) opt.mode = Mode::FM;
+            else if (strcmp(m, "QAM") == 0) opt.mode = Mode::QAM;
+            else {
+                std::cerr << "Unknown mode " << m << "\n";
+                return 1;
+            }
+        } else if (strcmp(arg, "--noise") == 0 && has_value) {
+            opt.noise_level = static_cast<float>(atof(argv[++i]));
+        } else if (strcmp(arg, "--echo") == 0) {
+            opt.echo = true;
+        } else if (strcmp(arg, "--seed") == 0 && has_value) {
+            opt.seed = strtoull(argv[++i], nullptr, 10);
+        } else if (strcmp(arg, "--block") == 0 && has_value) {
+            opt.block = strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(arg, "--oversample") == 0 && has_value) {
+            opt.oversample = atoi(argv[++i]);
+        } else if (strcmp(arg, "--channel-fir") == 0 && has_value) {
+            opt.channel_fir = atoi(argv[++i]);
+        } else if (strcmp(arg, "--post-fir") == 0 && has_value) {
+            opt.post_fir = atoi(argv[++i]);
+        } else if (strcmp(arg, "--rx-offset") == 0 && has_value) {
+            opt.rx_offset = static_cast<float>(atof(argv[++i]));
+        } else if (arg[0] == '-') {
+            printUsage();
+            return 1;
+        } else {
+            files.push_back(arg);
+        }
+    }
+    if (files.empty() || files.size() % 2 != 0 || opt.block == 0 || opt.oversample < 1 ||
+        opt.oversample > OVERSAMPLE_MAX) {
+        printUsage();
+        return 1;
+    }
+    std::cout << "DSP kernels: " << dspKernels().name << "\n";
+    int failures = 0;
+    for (size_t i = 0; i < files.size(); i += 2) {
+        if (!processFile(opt, files[i], files[i + 1])) failures++;
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,9 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+// Headless offline processing: runs the modem chain over audio files as fast
+// as the CPU allows. Arguments are everything after --batch; returns the
+// process exit code.
+int runBatch(int argc, char* argv[]);
+
+#endif // BATCH_H
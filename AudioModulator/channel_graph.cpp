@@ -0,0 +1,110 @@
+#include "channel_graph.h"
+
+// Spins before a worker blocks on the condition variable. Between
+// back-to-back blocks this keeps the hand-off off the kernel.
+#define WORKER_SPINS 20000
+
+ChannelGraph::ChannelGraph(size_t channel_count, size_t workers, size_t max_block) {
+    for (size_t c = 0; c < channel_count; c++) {
+        channels.emplace_back(new Channel);
+        channels[c]->state.noise.seed(c + 1);
+        channels[c]->mod.resize(max_block);
+        channels[c]->demod.resize(max_block);
+    }
+    if (workers < 1) workers = 1;
+    if (workers > channel_count) workers = channel_count > 0 ? channel_count : 1;
+    for (size_t w = 1; w < workers; w++)
+        threads.emplace_back(&ChannelGraph::workerLoop, this, w);
+}
+
+ChannelGraph::~ChannelGraph() {
+    stopping.store(true);
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex);
+        generation.fetch_add(1);
+    }
+    wake.notify_all();
+    for (std::thread& t : threads) t.join();
+}
+
+void ChannelGraph::process(const float* in, size_t n) {
+    block_in = in;
+    block_size = n;
+    finished.store(0, std::memory_order_relaxed);
+    generation.fetch_add(1); // publishes block_in/block_size
+    if (sleepers.load() > 0) {
+        std::lock_guard<std::mutex> lock(wake_mutex);
+        wake.notify_all();
+    }
+    runChannels(0);
+    while (finished.load(std::memory_order_acquire) < threads.size()) {}
+}
+
+// Chains of one mode collected so their receivers run in SIMD lanes.
+struct ChannelGraph::LaneGroup {
+    Mode mode;
+    size_t count = 0;
+    Channel* channels[CHANNEL_LANES];
+    ModemState* states[CHANNEL_LANES];
+    float* mod[CHANNEL_LANES];
+    float* demod[CHANNEL_LANES];
+
+    explicit LaneGroup(Mode m) : mode(m) {}
+    void add(Channel& ch) {
+        channels[count] = &ch;
+        states[count] = &ch.state;
+        mod[count] = ch.mod.data();
+        demod[count] = ch.demod.data();
+        count++;
+    }
+};
+
+void ChannelGraph::runLaneGroup(LaneGroup& g) {
+    processBlockLanes(g.mode, g.states, block_in, g.mod, g.demod, g.count, block_size);
+    for (size_t i = 0; i < g.count; i++) {
+        Channel& ch = *g.channels[i];
+        if (ch.echo.load(std::memory_order_relaxed)) applyEcho(ch.state, ch.demod.data(), block_size);
+    }
+    g.count = 0;
+}
+
+void ChannelGraph::runChannels(size_t worker) {
+    size_t stride = threads.size() + 1;
+    // AM and QAM chains at the audio rate are collected per mode and run
+    // CHANNEL_LANES at a time, so their envelope filters and carrier loops
+    // share SIMD lanes.
+    LaneGroup am(Mode::AM), qam(Mode::QAM);
+    for (size_t c = worker; c < channels.size(); c += stride) {
+        Channel& ch = *channels[c];
+        ch.state.noise.setLevel(ch.noise_level.load(std::memory_order_relaxed));
+        Mode mode = ch.mode.load(std::memory_order_relaxed);
+        if (mode != Mode::FM && ch.state.oversample == 1) {
+            LaneGroup& g = mode == Mode::AM ? am : qam;
+            g.add(ch);
+            if (g.count == CHANNEL_LANES) runLaneGroup(g);
+            continue;
+        }
+        processBlock(mode, ch.state, block_in, ch.mod.data(), ch.demod.data(), block_size);
+        if (ch.echo.load(std::memory_order_relaxed)) applyEcho(ch.state, ch.demod.data(), block_size);
+    }
+    if (am.count > 0) runLaneGroup(am);
+    if (qam.count > 0) runLaneGroup(qam);
+}
+
+void ChannelGraph::workerLoop(size_t worker) {
+    uint64_t seen = 0;
+    while (true) {
+        uint64_t g = generation.load(std::memory_order_acquire);
+        for (int i = 0; i < WORKER_SPINS && g == seen; i++) g = generation.load(std::memory_order_acquire);
+        if (g == seen) {
+            std::unique_lock<std::mutex> lock(wake_mutex);
+            sleepers.fetch_add(1);
+            wake.wait(lock, [&] { return (g = generation.load()) != seen; });
+            sleepers.fetch_sub(1);
+        }
+        seen = g;
+        if (stopping.load()) return;
+        runChannels(worker);
+        finished.fetch_add(1, std::memory_order_release);
+    }
+}
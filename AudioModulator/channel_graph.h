@@ -0,0 +1,67 @@
+#ifndef CHANNEL_GRAPH_H
+#define CHANNEL_GRAPH_H
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "modem.h"
+
+// N independent modulator/channel/demodulator chains fed from one input and
+// run over a fixed worker pool. Chain c always runs on worker c % workers
+// (worker 0 being the thread that calls process()), and process() returns
+// only when every chain has finished the block, so results never depend on
+// thread timing.
+class ChannelGraph {
+public:
+    ChannelGraph(size_t channels, size_t workers, size_t max_block);
+    ~ChannelGraph();
+
+    size_t channelCount() const { return channels.size(); }
+    size_t workerCount() const { return threads.size() + 1; }
+
+    // Per-chain controls, safe to call from any thread while processing.
+    void setMode(size_t ch, Mode m) { channels[ch]->mode.store(m, std::memory_order_relaxed); }
+    void setNoiseLevel(size_t ch, float level) { channels[ch]->noise_level.store(level, std::memory_order_relaxed); }
+    void setEcho(size_t ch, bool on) { channels[ch]->echo.store(on, std::memory_order_relaxed); }
+
+    // Setup only (no processing running).
+    ModemState& state(size_t ch) { return channels[ch]->state; }
+
+    // Run every chain over n <= max_block input samples.
+    void process(const float* in, size_t n);
+
+    // Results of the last process() call.
+    const float* modulated(size_t ch) const { return channels[ch]->mod.data(); }
+    const float* demodulated(size_t ch) const { return channels[ch]->demod.data(); }
+
+private:
+    struct Channel {
+        ModemState state;
+        std::atomic<Mode> mode{Mode::AM};
+        std::atomic<float> noise_level{0.1f};
+        std::atomic<bool> echo{false};
+        std::vector<float> mod, demod;
+    };
+
+    struct LaneGroup;
+
+    void runChannels(size_t worker);
+    void runLaneGroup(LaneGroup& group);
+    void workerLoop(size_t worker);
+
+    std::vector<std::unique_ptr<Channel>> channels;
+    std::vector<std::thread> threads;
+    const float* block_in = nullptr;
+    size_t block_size = 0;
+    std::atomic<uint64_t> generation{0};
+    std::atomic<size_t> finished{0};
+    std::atomic<int> sleepers{0};
+    std::atomic<bool> stopping{false};
+    std::mutex wake_mutex;
+    std::condition_variable wake;
+};
+
+#endif // CHANNEL_GRAPH_H
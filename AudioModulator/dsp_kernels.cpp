@@ -0,0 +1,74 @@
+#include "dsp_kernels_impl.h"
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef MODEM_X86_KERNELS
+const DspKernels* sse2Kernels();
+const DspKernels* avx2Kernels();
+const DspKernels* avx512Kernels();
+#endif
+
+OnePole makeOnePole(float alpha) {
+    OnePole f;
+    f.alpha = alpha;
+    for (int d = -ONE_POLE_LANES; d < ONE_POLE_LANES; d++)
+        f.taps[ONE_POLE_LANES + d] = d < 0 ? 0.0f : alpha * powf(1.0f - alpha, static_cast<float>(d));
+    for (int k = 0; k < ONE_POLE_LANES; k++)
+        f.powers[k] = powf(1.0f - alpha, static_cast<float>(k + 1));
+    return f;
+}
+
+// Bilinear transform of the analog prototype, one conjugate pole pair per
+// section with Q = 1 / (2 cos theta_k).
+std::vector<Biquad> designButterworthLowpass(int sections, double cutoff) {
+    std::vector<Biquad> cascade(sections);
+    double w0 = 2 * M_PI * cutoff;
+    double cw = cos(w0), sw = sin(w0);
+    for (int k = 0; k < sections; k++) {
+        double q = 1.0 / (2 * cos(M_PI * (2 * k + 1) / (4.0 * sections)));
+        double alpha = sw / (2 * q);
+        double a0 = 1 + alpha;
+        Biquad& b = cascade[k];
+        b.b0 = static_cast<float>((1 - cw) / 2 / a0);
+        b.b1 = static_cast<float>((1 - cw) / a0);
+        b.b2 = b.b0;
+        b.a1 = static_cast<float>(-2 * cw / a0);
+        b.a2 = static_cast<float>((1 - alpha) / a0);
+    }
+    return cascade;
+}
+
+static const DspKernels* scalarKernels() {
+    static const DspKernels k = makeKernels<ScalarVec>("scalar");
+    return &k;
+}
+
+const DspKernels* findDspKernels(const char* name) {
+    if (strcmp(name, "scalar") == 0) return scalarKernels();
+#ifdef MODEM_X86_KERNELS
+    __builtin_cpu_init();
+    if (strcmp(name, "sse2") == 0 && __builtin_cpu_supports("sse2")) return sse2Kernels();
+    if (strcmp(name, "avx2") == 0 && __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        return avx2Kernels();
+    if (strcmp(name, "avx512") == 0 && __builtin_cpu_supports("avx512f")) return avx512Kernels();
+#endif
+    return nullptr;
+}
+
+static const DspKernels* selectDspKernels() {
+    const char* forced = getenv("MODEM_SIMD");
+    if (forced) {
+        if (const DspKernels* k = findDspKernels(forced)) return k;
+    }
+    static const char* const preferred[] = {"avx512", "avx2", "sse2"};
+    for (const char* name : preferred) {
+        if (const DspKernels* k = findDspKernels(name)) return k;
+    }
+    return scalarKernels();
+}
+
+const DspKernels& dspKernels() {
+    static const DspKernels* kernels = selectDspKernels();
+    return *kernels;
+}
@@ -0,0 +1,118 @@
+#ifndef DSP_KERNELS_H
+#define DSP_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#define ONE_POLE_LANES 16
+#define NOISE_LANES 16 // independent generators in the Gaussian noise kernel
+
+// One-pole lowpass y += alpha * (x - y), unrolled so a block of up to
+// ONE_POLE_LANES outputs is a sum of broadcast inputs times fixed taps. This
+// breaks the sample-to-sample dependency that keeps the recursion scalar.
+struct OnePole {
+    float alpha;
+    float taps[2 * ONE_POLE_LANES];  // taps[ONE_POLE_LANES + d] = alpha * (1 - alpha)^d, zero for d < 0
+    float powers[ONE_POLE_LANES];    // powers[k] = (1 - alpha)^(k + 1)
+};
+
+OnePole makeOnePole(float alpha);
+
+#define CHANNEL_LANES 16 // most channels processed side by side in one biquadCascade or costas call
+
+// One second-order section, a0 normalized to 1:
+// y = b0 x + b1 x[-1] + b2 x[-2] - a1 y[-1] - a2 y[-2]
+struct Biquad {
+    float b0, b1, b2, a1, a2;
+};
+
+// Butterworth lowpass of order 2 * sections, cutoff in cycles per sample.
+std::vector<Biquad> designButterworthLowpass(int sections, double cutoff);
+
+// QAM carrier recovery loops for up to CHANNEL_LANES channels, one per lane.
+// Each field is lane-minor, so one vector load picks it for consecutive
+// channels.
+struct CostasLanes {
+    uint32_t phase[CHANNEL_LANES]; // receiver NCO phase
+    uint32_t inc[CHANNEL_LANES];   // nominal carrier step per sample
+    float arm_i[CHANNEL_LANES];    // lowpassed in * sin
+    float arm_q[CHANNEL_LANES];    // lowpassed in * cos
+    float freq[CHANNEL_LANES];     // loop integrator: carrier offset, cycles per sample
+    // Phase marker tracking. Counters are floats so they share the vector
+    // registers; -1 in ref_pos means outside a reference symbol.
+    float level[CHANNEL_LANES];    // smoothed |arm_i| + |arm_q|
+    float quiet[CHANNEL_LANES];    // samples the level has been below threshold
+    float ref_pos[CHANNEL_LANES];  // position in a marker's reference symbol
+    float ref_i[CHANNEL_LANES];    // arms summed over the reference window
+    float ref_q[CHANNEL_LANES];
+    float rot_c[CHANNEL_LANES];    // derotation: I = rot_c * arm_i + rot_s * arm_q
+    float rot_s[CHANNEL_LANES];
+    float last_out[CHANNEL_LANES]; // output held through a marker
+};
+
+// Constants shared by every lane: arm lowpass alpha and the proportional/
+// integral gains of the loop filter (cycles per unit error), then the marker
+// detector: level smoothing alpha and threshold, the quiet run that makes a
+// marker, and where the reference window starts and ends and the reference
+// symbol stops, in samples from its detection.
+struct CostasParams {
+    float arm_alpha, kp, ki;
+    float level_alpha, level_threshold, quiet_min;
+    float ref_begin, ref_end, ref_stop;
+};
+
+// Block kernels for the modem stages. Every instruction set provides the same
+// table; dspKernels() picks the widest one the CPU supports.
+struct DspKernels {
+    const char* name;
+    int width; // floats per vector
+    // Advance an NCO phase n times, writing sine (and cosine, if non-null) of each new phase.
+    void (*oscillator)(uint32_t* phase, uint32_t inc, const float* table, float* sin_out, float* cos_out, size_t n);
+    // Table sine of arbitrary phases.
+    void (*sineOf)(const uint32_t* phase, const float* table, float* out, size_t n);
+    // out = (1 + audio) * 0.5 * carrier
+    void (*mixAM)(const float* audio, const float* carrier, float* out, size_t n);
+    // out = 0.5 * (I * sin + Q * cos) with I, Q sliced from the audio sample
+    void (*mixQAM)(const float* audio, const float* sin_c, const float* cos_c, float* out, size_t n);
+    // out = lowpass(in), filter state carried in *state
+    void (*lowpass)(const float* in, float* out, const OnePole& f, float* state, size_t n);
+    // `lanes` independent biquad cascades over frame-interleaved samples
+    // (in[t * lanes + c]). coeffs are [section][b0 b1 b2 a1 a2][lane], state
+    // [section][2][lane]. in and out may be the same buffer.
+    void (*biquadCascade)(const float* coeffs, float* state, size_t sections, size_t lanes, const float* in, float* out,
+                          size_t frames);
+    // i = in * cos, q = -in * sin
+    void (*downmix)(const float* in, const float* sin_c, const float* cos_c, float* i_out, float* q_out, size_t n);
+    // out[j] = sum_k taps[k] * in[j + k]: taps in reverse time order, in holds
+    // ntaps - 1 samples of history ahead of the n new ones.
+    void (*fir)(const float* taps, size_t ntaps, const float* in, float* out, size_t n);
+    // out[j] = sum_k taps[k] * in[j * factor + k]: fir() keeping every factor-th output.
+    void (*firDecimate)(const float* taps, size_t ntaps, const float* in, size_t factor, float* out, size_t n);
+    // Costas loop over frame-interleaved samples (in[t * lanes + c]): mixes
+    // each channel down with its own NCO, steers the NCO with a decision-
+    // directed QPSK phase error, and writes the sliced I arm (+-0.5) after
+    // undoing the rotation the last phase marker showed. in and out may be
+    // the same buffer.
+    void (*costas)(CostasLanes& loops, const CostasParams& g, const float* table, size_t lanes, const float* in,
+                   float* out, size_t frames);
+    // y += x * h over split-complex arrays
+    void (*complexMulAdd)(const float* xr, const float* xi, const float* hr, const float* hi, float* yr, float* yi,
+                          size_t n);
+    // out = gain * arg(z[j] * conj(z[j - 1])) with z = i + jq; reads i[-1], q[-1].
+    void (*fmDiscriminate)(const float* i_in, const float* q_in, float gain, float* out, size_t n);
+    // buf += gain * delay; delay = buf (delay line longer than the block)
+    void (*echo)(float* buf, float* delay, float gain, size_t n);
+    // buf += sigma * N(0, 1) over chunks * 2 * NOISE_LANES samples; state is
+    // 4 * NOISE_LANES xoshiro128+ words, lane-major per word.
+    void (*addGaussian)(uint32_t* state, const float* table, float sigma, float* buf, size_t chunks);
+};
+
+// Kernels chosen for this CPU. MODEM_SIMD=scalar|sse2|avx2|avx512 in the
+// environment forces a narrower set.
+const DspKernels& dspKernels();
+
+// Kernels by name, or nullptr if unknown or not supported by this CPU.
+const DspKernels* findDspKernels(const char* name);
+
+#endif // DSP_KERNELS_H
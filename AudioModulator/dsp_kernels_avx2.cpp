@@ -0,0 +1,42 @@
+#include <immintrin.h>
+#include "dsp_kernels_impl.h"
+
+namespace {
+struct Avx2Vec {
+    typedef __m256 F;
+    typedef __m256i I;
+    typedef __m256 M;
+    static const int width = 8;
+    static F load(const float* p) { return _mm256_loadu_ps(p); }
+    static void store(float* p, F v) { _mm256_storeu_ps(p, v); }
+    static F set1(float x) { return _mm256_set1_ps(x); }
+    static F add(F a, F b) { return _mm256_add_ps(a, b); }
+    static F sub(F a, F b) { return _mm256_sub_ps(a, b); }
+    static F mul(F a, F b) { return _mm256_mul_ps(a, b); }
+    static F fmadd(F a, F b, F c) { return _mm256_fmadd_ps(a, b, c); }
+    static F abs(F a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+    static M gt(F a, F b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+    static F select(M m, F a, F b) { return _mm256_blendv_ps(b, a, m); }
+    static I loadi(const uint32_t* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+    static I set1i(uint32_t x) { return _mm256_set1_epi32(static_cast<int>(x)); }
+    static I addi(I a, I b) { return _mm256_add_epi32(a, b); }
+    static I andi(I a, I b) { return _mm256_and_si256(a, b); }
+    static void storei(uint32_t* p, I v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+    static I xori(I a, I b) { return _mm256_xor_si256(a, b); }
+    static I ori(I a, I b) { return _mm256_or_si256(a, b); }
+    template <int k> static I shl(I a) { return _mm256_slli_epi32(a, k); }
+    template <int k> static I shr(I a) { return _mm256_srli_epi32(a, k); }
+    static F cvt(I a) { return _mm256_cvtepi32_ps(a); }
+    static I cvti(F a) { return _mm256_cvttps_epi32(a); }
+    static F asFloat(I a) { return _mm256_castsi256_ps(a); }
+    static I asInt(F a) { return _mm256_castps_si256(a); }
+    static F div(F a, F b) { return _mm256_div_ps(a, b); }
+    static F sqrt(F a) { return _mm256_sqrt_ps(a); }
+    static F gather(const float* table, I idx) { return _mm256_i32gather_ps(table, idx, 4); }
+};
+}
+
+const DspKernels* avx2Kernels() {
+    static const DspKernels k = makeKernels<Avx2Vec>("avx2");
+    return &k;
+}
@@ -0,0 +1,42 @@
+#include <immintrin.h>
+#include "dsp_kernels_impl.h"
+
+namespace {
+struct Avx512Vec {
+    typedef __m512 F;
+    typedef __m512i I;
+    typedef __mmask16 M;
+    static const int width = 16;
+    static F load(const float* p) { return _mm512_loadu_ps(p); }
+    static void store(float* p, F v) { _mm512_storeu_ps(p, v); }
+    static F set1(float x) { return _mm512_set1_ps(x); }
+    static F add(F a, F b) { return _mm512_add_ps(a, b); }
+    static F sub(F a, F b) { return _mm512_sub_ps(a, b); }
+    static F mul(F a, F b) { return _mm512_mul_ps(a, b); }
+    static F fmadd(F a, F b, F c) { return _mm512_fmadd_ps(a, b, c); }
+    static F abs(F a) { return _mm512_abs_ps(a); }
+    static M gt(F a, F b) { return _mm512_cmp_ps_mask(a, b, _CMP_GT_OQ); }
+    static F select(M m, F a, F b) { return _mm512_mask_blend_ps(m, b, a); }
+    static I loadi(const uint32_t* p) { return _mm512_loadu_si512(p); }
+    static I set1i(uint32_t x) { return _mm512_set1_epi32(static_cast<int>(x)); }
+    static I addi(I a, I b) { return _mm512_add_epi32(a, b); }
+    static I andi(I a, I b) { return _mm512_and_si512(a, b); }
+    static void storei(uint32_t* p, I v) { _mm512_storeu_si512(p, v); }
+    static I xori(I a, I b) { return _mm512_xor_si512(a, b); }
+    static I ori(I a, I b) { return _mm512_or_si512(a, b); }
+    template <int k> static I shl(I a) { return _mm512_slli_epi32(a, k); }
+    template <int k> static I shr(I a) { return _mm512_srli_epi32(a, k); }
+    static F cvt(I a) { return _mm512_cvtepi32_ps(a); }
+    static I cvti(F a) { return _mm512_cvttps_epi32(a); }
+    static F asFloat(I a) { return _mm512_castsi512_ps(a); }
+    static I asInt(F a) { return _mm512_castps_si512(a); }
+    static F div(F a, F b) { return _mm512_div_ps(a, b); }
+    static F sqrt(F a) { return _mm512_sqrt_ps(a); }
+    static F gather(const float* table, I idx) { return _mm512_i32gather_ps(idx, table, 4); }
+};
+}
+
+const DspKernels* avx512Kernels() {
+    static const DspKernels k = makeKernels<Avx512Vec>("avx512");
+    return &k;
+}
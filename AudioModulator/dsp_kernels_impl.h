@@ -0,0 +1,454 @@
+// Kernel bodies shared by every instruction set. Each dsp_kernels*.cpp defines
+// a vector traits struct, includes this file and instantiates makeKernels<>
+// with it. Everything here has internal linkage so code built with AVX flags
+// can never be picked by the linker for the scalar path.
+
+#include "dsp_kernels.h"
+#include "nco.h"
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+struct ScalarVec {
+    typedef float F;
+    typedef uint32_t I;
+    typedef bool M;
+    static const int width = 1;
+    static F load(const float* p) { return *p; }
+    static void store(float* p, F v) { *p = v; }
+    static F set1(float x) { return x; }
+    static F add(F a, F b) { return a + b; }
+    static F sub(F a, F b) { return a - b; }
+    static F mul(F a, F b) { return a * b; }
+    static F fmadd(F a, F b, F c) { return a * b + c; }
+    static F abs(F a) { return a < 0 ? -a : a; }
+    static M gt(F a, F b) { return a > b; }
+    static F select(M m, F a, F b) { return m ? a : b; }
+    static I loadi(const uint32_t* p) { return *p; }
+    static I set1i(uint32_t x) { return x; }
+    static I addi(I a, I b) { return a + b; }
+    static I andi(I a, I b) { return a & b; }
+    static void storei(uint32_t* p, I v) { *p = v; }
+    static I xori(I a, I b) { return a ^ b; }
+    static I ori(I a, I b) { return a | b; }
+    template <int k> static I shl(I a) { return a << k; }
+    template <int k> static I shr(I a) { return a >> k; }
+    static F cvt(I a) { return static_cast<float>(a); }
+    static I cvti(F a) { return static_cast<uint32_t>(static_cast<int32_t>(a)); } // signed, truncating
+    static F asFloat(I a) { F f; memcpy(&f, &a, sizeof(f)); return f; }
+    static I asInt(F a) { I i; memcpy(&i, &a, sizeof(i)); return i; }
+    static F div(F a, F b) { return a / b; }
+    static F sqrt(F a) { return sqrtf(a); }
+    static F gather(const float* table, I idx) { return table[idx]; }
+};
+
+template <class V>
+inline typename V::F sineLookup(typename V::I p, const float* table) {
+    typename V::I idx = V::template shr<NCO_FRAC_BITS>(p);
+    typename V::F frac = V::mul(V::cvt(V::andi(p, V::set1i((1u << NCO_FRAC_BITS) - 1))),
+                                V::set1(1.0f / (1u << NCO_FRAC_BITS)));
+    typename V::F lo = V::gather(table, idx);
+    typename V::F hi = V::gather(table + 1, idx);
+    return V::fmadd(frac, V::sub(hi, lo), lo);
+}
+
+template <class V>
+void oscillator(uint32_t* phase, uint32_t inc, const float* table, float* sin_out, float* cos_out, size_t n) {
+    uint32_t acc = *phase;
+    uint32_t lanes[V::width];
+    for (int k = 0; k < V::width; k++) lanes[k] = acc + (k + 1) * inc;
+    typename V::I p = V::loadi(lanes);
+    typename V::I step = V::set1i(inc * V::width);
+    typename V::I quarter = V::set1i(0x40000000u);
+    size_t i = 0;
+    for (; i + V::width <= n; i += V::width) {
+        V::store(sin_out + i, sineLookup<V>(p, table));
+        if (cos_out) V::store(cos_out + i, sineLookup<V>(V::addi(p, quarter), table));
+        p = V::addi(p, step);
+    }
+    acc += inc * static_cast<uint32_t>(i);
+    *phase = acc;
+    if (V::width > 1 && i < n)
+        oscillator<ScalarVec>(phase, inc, table, sin_out + i, cos_out ? cos_out + i : nullptr, n - i);
+}
+
+template <class V>
+void sineOf(const uint32_t* phase, const float* table, float* out, size_t n) {
+    size_t i = 0;
+    for (; i + V::width <= n; i += V::width)
+        V::store(out + i, sineLookup<V>(V::loadi(phase + i), table));
+    if (V::width > 1 && i < n) sineOf<ScalarVec>(phase + i, table, out + i, n - i);
+}
+
+template <class V>
+void mixAM(const float* audio, const float* carrier, float* out, size_t n) {
+    typename V::F half = V::set1(0.5f);
+    size_t i = 0;
+    for (; i + V::width <= n; i += V::width) {
+        typename V::F c = V::mul(V::load(carrier + i), half);
+        V::store(out + i, V::fmadd(V::load(audio + i), c, c));
+    }
+    if (V::width > 1 && i < n) mixAM<ScalarVec>(audio + i, carrier + i, out + i, n - i);
+}
+
+template <class V>
+void mixQAM(const float* audio, const float* sin_c, const float* cos_c, float* out, size_t n) {
+    typename V::F zero = V::set1(0.0f), half = V::set1(0.5f);
+    size_t i = 0;
+    for (; i + V::width <= n; i += V::width) {
+        typename V::F a = V::load(audio + i);
+        typename V::F s = V::load(sin_c + i), c = V::load(cos_c + i);
+        typename V::F is = V::select(V::gt(a, zero), s, V::sub(zero, s));
+        typename V::F qc = V::select(V::gt(V::abs(a), half), c, V::sub(zero, c));
+        V::store(out + i, V::mul(half, V::add(is, qc)));
+    }
+    if (V::width > 1 && i < n) mixQAM<ScalarVec>(audio + i, sin_c + i, cos_c + i, out + i, n - i);
+}
+
+template <class V>
+void lowpass(const float* in, float* out, const OnePole& f, float* state, size_t n) {
+    typename V::F powers = V::load(f.powers);
+    float y = *state;
+    float lanes[V::width];
+    size_t i = 0;
+    for (; i + V::width <= n; i += V::width) {
+        typename V::F acc = V::mul(powers, V::set1(y));
+        for (int j = 0; j < V::width; j++)
+            acc = V::fmadd(V::load(f.taps + ONE_POLE_LANES - j), V::set1(in[i + j]), acc);
+        V::store(lanes, acc);
+        V::store(out + i, acc);
+        y = lanes[V::width - 1];
+    }
+    *state = y;
+    if (V::width > 1 && i < n) lowpass<ScalarVec>(in + i, out + i, f, state, n - i);
+}
+
+// Transposed direct form II, one channel per lane, lanes [begin, end) of
+// `stride`. Sections run one after another over the whole block, the first
+// reading `in` and the rest working in place on `out`.
+template <class V>
+void biquadLanes(const float* coeffs, float* state, size_t sections, size_t stride, size_t begin, size_t end,
+                 const float* in, float* out, size_t frames) {
+    size_t l = begin;
+    for (; l + V::width <= end; l += V::width) {
+        for (size_t sec = 0; sec < sections; sec++) {
+            const float* c = coeffs + sec * 5 * stride + l;
+            float* st = state + sec * 2 * stride + l;
+            typename V::F b0 = V::load(c), b1 = V::load(c + stride), b2 = V::load(c + 2 * stride);
+            typename V::F a1 = V::load(c + 3 * stride), a2 = V::load(c + 4 * stride);
+            typename V::F s1 = V::load(st), s2 = V::load(st + stride);
+            const float* src = sec == 0 ? in : out;
+            for (size_t t = 0; t < frames; t++) {
+                typename V::F x = V::load(src + t * stride + l);
+                typename V::F y = V::fmadd(b0, x, s1);
+                s1 = V::fmadd(b1, x, V::sub(s2, V::mul(a1, y)));
+                s2 = V::sub(V::mul(b2, x), V::mul(a2, y));
+                V::store(out + t * stride + l, y);
+            }
+            V::store(st, s1);
+            V::store(st + stride, s2);
+        }
+    }
+    if (V::width > 1 && l < end) biquadLanes<ScalarVec>(coeffs, state, sections, stride, l, end, in, out, frames);
+}
+
+template <class V>
+void biquadCascade(const float* coeffs, float* state, size_t sections, size_t lanes, const float* in, float* out,
+                   size_t frames) {
+    biquadLanes<V>(coeffs, state, sections, lanes, 0, lanes, in, out, frames);
+}
+
+// i = in * cos, q = -in * sin: the carrier shifted down to 0 Hz, with its
+// image at twice the carrier still to be filtered out.
+template <class V>
+void downmix(const float* in, const float* sin_c, const float* cos_c, float* i_out, float* q_out, size_t n) {
+    typename V::F zero = V::set1(0.0f);
+    size_t i = 0;
+    for (; i + V::width <= n; i += V::width) {
+        typename V::F x = V::load(in + i);
+        V::store(i_out + i, V::mul(x, V::load(cos_c + i)));
+        V::store(q_out + i, V::mul(V::sub(zero, x), V::load(sin_c + i)));
+    }
+    if (V::width > 1 && i < n) downmix<ScalarVec>(in + i, sin_c + i, cos_c + i, i_out + i, q_out + i, n - i);
+}
+
+// Four output vectors per pass so the FMA latency of one accumulator chain
+// is hidden behind the other three.
+template <class V>
+void fir(const float* taps, size_t ntaps, const float* in, float* out, size_t n) {
+    size_t i = 0;
+    for (; i + 4 * V::width <= n; i += 4 * V::width) {
+        typename V::F acc0 = V::set1(0.0f), acc1 = acc0, acc2 = acc0, acc3 = acc0;
+        const float* x = in + i;
+        for (size_t k = 0; k < ntaps; k++) {
+            typename V::F t = V::set1(taps[k]);
+            acc0 = V::fmadd(t, V::load(x + k), acc0);
+            acc1 = V::fmadd(t, V::load(x + k + V::width), acc1);
+            acc2 = V::fmadd(t, V::load(x + k + 2 * V::width), acc2);
+            acc3 = V::fmadd(t, V::load(x + k + 3 * V::width), acc3);
+        }
+        V::store(out + i, acc0);
+        V::store(out + i + V::width, acc1);
+        V::store(out + i + 2 * V::width, acc2);
+        V::store(out + i + 3 * V::width, acc3);
+    }
+    for (; i + V::width <= n; i += V::width) {
+        typename V::F acc = V::set1(0.0f);
+        for (size_t k = 0; k < ntaps; k++)
+            acc = V::fmadd(V::set1(taps[k]), V::load(in + i + k), acc);
+        V::store(out + i, acc);
+    }
+    if (V::width > 1 && i < n) fir<ScalarVec>(taps, ntaps, in + i, out + i, n - i);
+}
+
+// Vectorized along the taps rather than the outputs, since consecutive
+// outputs start `factor` inputs apart.
+template <class V>
+void firDecimate(const float* taps, size_t ntaps, const float* in, size_t factor, float* out, size_t n) {
+    float lanes[V::width];
+    for (size_t j = 0; j < n; j++) {
+        const float* x = in + j * factor;
+        typename V::F acc = V::set1(0.0f), acc2 = acc;
+        size_t k = 0;
+        for (; k + 2 * V::width <= ntaps; k += 2 * V::width) {
+            acc = V::fmadd(V::load(taps + k), V::load(x + k), acc);
+            acc2 = V::fmadd(V::load(taps + k + V::width), V::load(x + k + V::width), acc2);
+        }
+        for (; k + V::width <= ntaps; k += V::width) acc = V::fmadd(V::load(taps + k), V::load(x + k), acc);
+        V::store(lanes, V::add(acc, acc2));
+        float sum = 0.0f;
+        for (int l = 0; l < V::width; l++) sum += lanes[l];
+        for (; k < ntaps; k++) sum += taps[k] * x[k];
+        out[j] = sum;
+    }
+}
+
+template <class V>
+void complexMulAdd(const float* xr, const float* xi, const float* hr, const float* hi, float* yr, float* yi, size_t n) {
+    size_t i = 0;
+    for (; i + V::width <= n; i += V::width) {
+        typename V::F a = V::load(xr + i), b = V::load(xi + i);
+        typename V::F c = V::load(hr + i), d = V::load(hi + i);
+        V::store(yr + i, V::fmadd(a, c, V::sub(V::load(yr + i), V::mul(b, d))));
+        V::store(yi + i, V::fmadd(a, d, V::fmadd(b, c, V::load(yi + i))));
+    }
+    if (V::width > 1 && i < n) complexMulAdd<ScalarVec>(xr + i, xi + i, hr + i, hi + i, yr + i, yi + i, n - i);
+}
+
+// Per sample and lane: advance the NCO, lowpass in * sin and in * cos into
+// the I and Q arms, and form e = sign(I) Q - sign(Q) I, which is -0.5 * the
+// phase error (radians) for a QPSK signal of unit symbols at amplitude 0.5.
+// The PI loop filter turns e into a phase correction, clamped to a quarter
+// cycle so the float to phase-unit conversion cannot overflow.
+template <class V>
+void costasLanes(CostasLanes& st, const CostasParams& g, const float* table, size_t begin, size_t end, size_t stride,
+                 const float* in, float* out, size_t frames) {
+    typename V::F zero = V::set1(0.0f), one = V::set1(1.0f), none = V::set1(-1.0f), half = V::set1(0.5f);
+    typename V::F alpha = V::set1(g.arm_alpha), kp = V::set1(g.kp), ki = V::set1(g.ki);
+    typename V::F limit = V::set1(0.25f), phase_units = V::set1(4294967296.0f);
+    typename V::F level_alpha = V::set1(g.level_alpha), threshold = V::set1(g.level_threshold);
+    // Counters are whole numbers, so compare against the bounds shifted by 0.5.
+    typename V::F quiet_min = V::set1(g.quiet_min - 0.5f), outside = V::set1(-0.5f);
+    typename V::F ref_begin = V::set1(g.ref_begin - 0.5f), ref_end = V::set1(g.ref_end - 0.5f);
+    typename V::F ref_stop = V::set1(g.ref_stop - 0.5f);
+    typename V::I quarter = V::set1i(0x40000000u);
+    size_t l = begin;
+    for (; l + V::width <= end; l += V::width) {
+        typename V::I p = V::loadi(st.phase + l), inc = V::loadi(st.inc + l);
+        typename V::F ai = V::load(st.arm_i + l), aq = V::load(st.arm_q + l), freq = V::load(st.freq + l);
+        typename V::F level = V::load(st.level + l), quiet = V::load(st.quiet + l), ref_pos = V::load(st.ref_pos + l);
+        typename V::F ref_i = V::load(st.ref_i + l), ref_q = V::load(st.ref_q + l);
+        typename V::F rot_c = V::load(st.rot_c + l), rot_s = V::load(st.rot_s + l), last = V::load(st.last_out + l);
+        for (size_t t = 0; t < frames; t++) {
+            p = V::addi(p, inc);
+            typename V::F x = V::load(in + t * stride + l);
+            typename V::F s = sineLookup<V>(p, table), c = sineLookup<V>(V::addi(p, quarter), table);
+            ai = V::fmadd(alpha, V::sub(V::mul(x, s), ai), ai);
+            aq = V::fmadd(alpha, V::sub(V::mul(x, c), aq), aq);
+            typename V::F e = V::sub(V::select(V::gt(ai, zero), aq, V::sub(zero, aq)),
+                                     V::select(V::gt(aq, zero), ai, V::sub(zero, ai)));
+            freq = V::fmadd(ki, e, freq);
+            typename V::F step = V::fmadd(kp, e, freq);
+            step = V::select(V::gt(step, limit), limit, step);
+            step = V::select(V::gt(V::sub(zero, limit), step), V::sub(zero, limit), step);
+            p = V::addi(p, V::cvti(V::mul(step, phase_units)));
+
+            // Outside a marker: a long enough quiet run followed by signal
+            // starts a reference symbol; otherwise slice the derotated I arm.
+            level = V::fmadd(level_alpha, V::sub(V::add(V::abs(ai), V::abs(aq)), level), level);
+            typename V::M low = V::gt(threshold, level), marker = V::gt(quiet, quiet_min);
+            typename V::F data = V::select(V::gt(V::fmadd(rot_c, ai, V::mul(rot_s, aq)), zero), half, V::sub(zero, half));
+            typename V::F out_outside = V::select(low, last, V::select(marker, last, data));
+            typename V::F quiet_outside = V::select(low, V::add(quiet, one), zero);
+            typename V::F pos_outside = V::select(low, none, V::select(marker, zero, none));
+            // Inside one: sum the arms over the window, and at the stop take
+            // the derotation from the quadrant the reference I = Q = +1 landed in.
+            typename V::F weight = V::select(V::gt(ref_pos, ref_begin), V::select(V::gt(ref_end, ref_pos), one, zero), zero);
+            ref_i = V::fmadd(weight, ai, ref_i);
+            ref_q = V::fmadd(weight, aq, ref_q);
+            typename V::F next = V::add(ref_pos, one);
+            typename V::M stop = V::gt(next, ref_stop);
+            typename V::F si = V::select(V::gt(ref_i, zero), half, V::sub(zero, half));
+            typename V::F sq = V::select(V::gt(ref_q, zero), half, V::sub(zero, half));
+            typename V::M inside = V::gt(ref_pos, outside);
+            rot_c = V::select(inside, V::select(stop, V::add(si, sq), rot_c), rot_c);
+            rot_s = V::select(inside, V::select(stop, V::sub(sq, si), rot_s), rot_s);
+            last = V::select(inside, last, out_outside);
+            quiet = V::select(inside, quiet, quiet_outside);
+            ref_pos = V::select(inside, V::select(stop, none, next), pos_outside);
+            ref_i = V::select(inside, ref_i, zero);
+            ref_q = V::select(inside, ref_q, zero);
+            V::store(out + t * stride + l, last);
+        }
+        V::storei(st.phase + l, p);
+        V::store(st.arm_i + l, ai);
+        V::store(st.arm_q + l, aq);
+        V::store(st.freq + l, freq);
+        V::store(st.level + l, level);
+        V::store(st.quiet + l, quiet);
+        V::store(st.ref_pos + l, ref_pos);
+        V::store(st.ref_i + l, ref_i);
+        V::store(st.ref_q + l, ref_q);
+        V::store(st.rot_c + l, rot_c);
+        V::store(st.rot_s + l, rot_s);
+        V::store(st.last_out + l, last);
+    }
+    if (V::width > 1 && l < end) costasLanes<ScalarVec>(st, g, table, l, end, stride, in, out, frames);
+}
+
+template <class V>
+void costas(CostasLanes& loops, const CostasParams& g, const float* table, size_t lanes, const float* in, float* out,
+            size_t frames) {
+    costasLanes<V>(loops, g, table, 0, lanes, lanes, in, out, frames);
+}
+
+// atan2(y, x) from an odd polynomial on [0, 1] folded out to all four
+// quadrants, good to about 1e-5 rad. atan2(0, 0) is 0.
+template <class V>
+inline typename V::F atan2Approx(typename V::F y, typename V::F x) {
+    typename V::F zero = V::set1(0.0f);
+    typename V::F ax = V::abs(x), ay = V::abs(y);
+    typename V::M steep = V::gt(ay, ax);
+    typename V::F lo = V::select(steep, ax, ay), hi = V::select(steep, ay, ax);
+    typename V::F a = V::div(lo, V::select(V::gt(hi, zero), hi, V::set1(1.0f)));
+    typename V::F s = V::mul(a, a);
+    typename V::F p = V::fmadd(s, V::set1(-0.0464964749f), V::set1(0.15931422f));
+    p = V::fmadd(s, p, V::set1(-0.327622764f));
+    typename V::F r = V::fmadd(V::mul(s, a), p, a);
+    r = V::select(steep, V::sub(V::set1(1.57079633f), r), r);
+    r = V::select(V::gt(zero, x), V::sub(V::set1(3.14159265f), r), r);
+    return V::select(V::gt(zero, y), V::sub(zero, r), r);
+}
+
+template <class V>
+void fmDiscriminate(const float* i_in, const float* q_in, float gain, float* out, size_t n) {
+    typename V::F g = V::set1(gain);
+    size_t i = 0;
+    for (; i + V::width <= n; i += V::width) {
+        typename V::F ci = V::load(i_in + i), cq = V::load(q_in + i);
+        typename V::F prev_i = V::load(i_in + i - 1), prev_q = V::load(q_in + i - 1);
+        // z[n] * conj(z[n - 1])
+        typename V::F re = V::fmadd(ci, prev_i, V::mul(cq, prev_q));
+        typename V::F im = V::sub(V::mul(cq, prev_i), V::mul(ci, prev_q));
+        V::store(out + i, V::mul(g, atan2Approx<V>(im, re)));
+    }
+    if (V::width > 1 && i < n) fmDiscriminate<ScalarVec>(i_in + i, q_in + i, gain, out + i, n - i);
+}
+
+template <class V>
+void echo(float* buf, float* delay, float gain, size_t n) {
+    typename V::F g = V::set1(gain);
+    size_t i = 0;
+    for (; i + V::width <= n; i += V::width) {
+        typename V::F y = V::fmadd(V::load(delay + i), g, V::load(buf + i));
+        V::store(buf + i, y);
+        V::store(delay + i, y);
+    }
+    if (V::width > 1 && i < n) echo<ScalarVec>(buf + i, delay + i, gain, n - i);
+}
+
+// Natural log for x in (0, 1]: exponent from the float bits, mantissa through
+// the atanh series, good to about 1e-6.
+template <class V>
+inline typename V::F logApprox(typename V::F x) {
+    typename V::I bits = V::asInt(x);
+    typename V::F e = V::sub(V::cvt(V::template shr<23>(bits)), V::set1(127.0f));
+    typename V::F m = V::asFloat(V::ori(V::andi(bits, V::set1i(0x007FFFFFu)), V::set1i(0x3F800000u)));
+    typename V::F one = V::set1(1.0f);
+    typename V::F t = V::div(V::sub(m, one), V::add(m, one));
+    typename V::F t2 = V::mul(t, t);
+    typename V::F p = V::fmadd(t2, V::set1(2.0f / 11), V::set1(2.0f / 9));
+    p = V::fmadd(t2, p, V::set1(2.0f / 7));
+    p = V::fmadd(t2, p, V::set1(2.0f / 5));
+    p = V::fmadd(t2, p, V::set1(2.0f / 3));
+    p = V::fmadd(t2, p, V::set1(2.0f));
+    return V::fmadd(e, V::set1(0.69314718f), V::mul(t, p));
+}
+
+// One xoshiro128+ step on every lane.
+template <class V>
+inline typename V::I xoshiroNext(typename V::I& s0, typename V::I& s1, typename V::I& s2, typename V::I& s3) {
+    typename V::I result = V::addi(s0, s3);
+    typename V::I t = V::template shl<9>(s1);
+    s2 = V::xori(s2, s0);
+    s3 = V::xori(s3, s1);
+    s1 = V::xori(s1, s2);
+    s0 = V::xori(s0, s3);
+    s2 = V::xori(s2, t);
+    s3 = V::ori(V::template shl<11>(s3), V::template shr<21>(s3));
+    return result;
+}
+
+// Box-Muller over NOISE_LANES independent generators. Each chunk adds
+// sigma * N(0, 1) to 2 * NOISE_LANES samples; lane l feeds positions l (sine
+// half) and NOISE_LANES + l (cosine half), so the sequence does not depend on
+// the vector width.
+template <class V>
+void addGaussian(uint32_t* state, const float* table, float sigma, float* buf, size_t chunks) {
+    for (int l = 0; l < NOISE_LANES; l += V::width) {
+        typename V::I s0 = V::loadi(state + l);
+        typename V::I s1 = V::loadi(state + NOISE_LANES + l);
+        typename V::I s2 = V::loadi(state + 2 * NOISE_LANES + l);
+        typename V::I s3 = V::loadi(state + 3 * NOISE_LANES + l);
+        for (size_t c = 0; c < chunks; c++) {
+            float* out = buf + c * 2 * NOISE_LANES + l;
+            typename V::I x1 = xoshiroNext<V>(s0, s1, s2, s3);
+            typename V::I x2 = xoshiroNext<V>(s0, s1, s2, s3);
+            typename V::F u = V::mul(V::add(V::cvt(V::template shr<8>(x1)), V::set1(1.0f)),
+                                     V::set1(1.0f / 16777216.0f)); // (0, 1]
+            typename V::F r = V::mul(V::sqrt(V::mul(V::set1(-2.0f), logApprox<V>(u))), V::set1(sigma));
+            V::store(out, V::fmadd(r, sineLookup<V>(x2, table), V::load(out)));
+            V::store(out + NOISE_LANES,
+                     V::fmadd(r, sineLookup<V>(V::addi(x2, V::set1i(0x40000000u)), table), V::load(out + NOISE_LANES)));
+        }
+        V::storei(state + l, s0);
+        V::storei(state + NOISE_LANES + l, s1);
+        V::storei(state + 2 * NOISE_LANES + l, s2);
+        V::storei(state + 3 * NOISE_LANES + l, s3);
+    }
+}
+
+template <class V>
+DspKernels makeKernels(const char* name) {
+    DspKernels k;
+    k.name = name;
+    k.width = V::width;
+    k.oscillator = oscillator<V>;
+    k.sineOf = sineOf<V>;
+    k.mixAM = mixAM<V>;
+    k.mixQAM = mixQAM<V>;
+    k.lowpass = lowpass<V>;
+    k.biquadCascade = biquadCascade<V>;
+    k.costas = costas<V>;
+    k.downmix = downmix<V>;
+    k.fir = fir<V>;
+    k.firDecimate = firDecimate<V>;
+    k.complexMulAdd = complexMulAdd<V>;
+    k.fmDiscriminate = fmDiscriminate<V>;
+    k.echo = echo<V>;
+    k.addGaussian = addGaussian<V>;
+    return k;
+}
+
+}
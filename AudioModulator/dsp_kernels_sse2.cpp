@@ -0,0 +1,47 @@
+#include <emmintrin.h>
+#include "dsp_kernels_impl.h"
+
+namespace {
+struct Sse2Vec {
+    typedef __m128 F;
+    typedef __m128i I;
+    typedef __m128 M;
+    static const int width = 4;
+    static F load(const float* p) { return _mm_loadu_ps(p); }
+    static void store(float* p, F v) { _mm_storeu_ps(p, v); }
+    static F set1(float x) { return _mm_set1_ps(x); }
+    static F add(F a, F b) { return _mm_add_ps(a, b); }
+    static F sub(F a, F b) { return _mm_sub_ps(a, b); }
+    static F mul(F a, F b) { return _mm_mul_ps(a, b); }
+    static F fmadd(F a, F b, F c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+    static F abs(F a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+    static M gt(F a, F b) { return _mm_cmpgt_ps(a, b); }
+    static F select(M m, F a, F b) { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+    static I loadi(const uint32_t* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+    static I set1i(uint32_t x) { return _mm_set1_epi32(static_cast<int>(x)); }
+    static I addi(I a, I b) { return _mm_add_epi32(a, b); }
+    static I andi(I a, I b) { return _mm_and_si128(a, b); }
+    static void storei(uint32_t* p, I v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+    static I xori(I a, I b) { return _mm_xor_si128(a, b); }
+    static I ori(I a, I b) { return _mm_or_si128(a, b); }
+    template <int k> static I shl(I a) { return _mm_slli_epi32(a, k); }
+    template <int k> static I shr(I a) { return _mm_srli_epi32(a, k); }
+    static F cvt(I a) { return _mm_cvtepi32_ps(a); }
+    static I cvti(F a) { return _mm_cvttps_epi32(a); }
+    static F asFloat(I a) { return _mm_castsi128_ps(a); }
+    static I asInt(F a) { return _mm_castps_si128(a); }
+    static F div(F a, F b) { return _mm_div_ps(a, b); }
+    static F sqrt(F a) { return _mm_sqrt_ps(a); }
+    // No gather before AVX2.
+    static F gather(const float* table, I idx) {
+        uint32_t k[4];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(k), idx);
+        return _mm_setr_ps(table[k[0]], table[k[1]], table[k[2]], table[k[3]]);
+    }
+};
+}
+
+const DspKernels* sse2Kernels() {
+    static const DspKernels k = makeKernels<Sse2Vec>("sse2");
+    return &k;
+}
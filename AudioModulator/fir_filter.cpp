@@ -0,0 +1,184 @@
+#include "fir_filter.h"
+#include "dsp_kernels.h"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <mutex>
+
+std::vector<float> designLowpassFir(int count, double cutoff) {
+    std::vector<float> h(count);
+    double mid = (count - 1) / 2.0;
+    double sum = 0.0;
+    for (int k = 0; k < count; k++) {
+        double x = k - mid;
+        double sinc = x == 0 ? 2 * cutoff : sin(2 * M_PI * cutoff * x) / (M_PI * x);
+        double w = count == 1 ? 1.0
+                              : 0.42 - 0.5 * cos(2 * M_PI * k / (count - 1)) + 0.08 * cos(4 * M_PI * k / (count - 1));
+        h[k] = static_cast<float>(sinc * w);
+        sum += h[k];
+    }
+    // A zero cutoff passes nothing: every tap is 0 and so is the sum.
+    if (sum == 0.0) return std::vector<float>(count, 0.0f);
+    for (float& v : h) v = static_cast<float>(v / sum);
+    return h;
+}
+
+std::vector<float> designBandpassFir(int count, double low, double high) {
+    std::vector<float> h = designLowpassFir(count, high);
+    if (low <= 0.0) return h;
+    std::vector<float> l = designLowpassFir(count, low);
+    for (int k = 0; k < count; k++) h[k] -= l[k];
+    return h;
+}
+
+namespace {
+struct FftPlans {
+    fftwf_plan forward;
+    fftwf_plan inverse;
+};
+}
+
+// Split-complex real transforms of one size, made once and shared by every
+// filter through the new-array execute functions. The FFTW planner is not
+// thread-safe, so planning is serialized.
+static FftPlans fftPlans(size_t size) {
+    static std::mutex mutex;
+    static std::map<size_t, FftPlans> plans;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = plans.find(size);
+    if (it != plans.end()) return it->second;
+    float* t = (float*)fftwf_malloc(sizeof(float) * size);
+    float* re = (float*)fftwf_malloc(sizeof(float) * (size / 2 + 1));
+    float* im = (float*)fftwf_malloc(sizeof(float) * (size / 2 + 1));
+    fftwf_iodim dim;
+    dim.n = static_cast<int>(size);
+    dim.is = 1;
+    dim.os = 1;
+    FftPlans p;
+    p.forward = fftwf_plan_guru_split_dft_r2c(1, &dim, 0, nullptr, t, re, im, FFTW_MEASURE);
+    p.inverse = fftwf_plan_guru_split_dft_c2r(1, &dim, 0, nullptr, re, im, t, FFTW_MEASURE);
+    fftwf_free(t);
+    fftwf_free(re);
+    fftwf_free(im);
+    plans.insert(std::make_pair(size, p));
+    return p;
+}
+
+// Spectra are stored at a stride padded to 16 floats so every one starts as
+// aligned as the arrays the plans were made with.
+static size_t binStride(size_t block) {
+    return (block + 1 + 15) & ~static_cast<size_t>(15);
+}
+
+static float* allocFloats(size_t n) {
+    float* p = (float*)fftwf_malloc(sizeof(float) * n);
+    std::fill(p, p + n, 0.0f);
+    return p;
+}
+
+FirFilter::FirFilter(const std::vector<float>& taps, size_t partition) : ntaps(taps.size()) {
+    if (ntaps < FIR_FFT_MIN_TAPS) {
+        // An empty kernel passes the input through.
+        reversed = taps.empty() ? std::vector<float>(1, 1.0f) : taps;
+        ntaps = reversed.size();
+        std::reverse(reversed.begin(), reversed.end());
+        history.assign(ntaps - 1, 0.0f);
+        return;
+    }
+    block = std::max<size_t>(partition, 16);
+    partitions = (ntaps + block - 1) / block;
+    size_t stride = binStride(block);
+    FftPlans plans = fftPlans(2 * block);
+    forward = plans.forward;
+    inverse = plans.inverse;
+    kernel_re = allocFloats(partitions * stride);
+    kernel_im = allocFloats(partitions * stride);
+    fdl_re = allocFloats(partitions * stride);
+    fdl_im = allocFloats(partitions * stride);
+    acc_re = allocFloats(stride);
+    acc_im = allocFloats(stride);
+    frame = allocFloats(2 * block);
+    result = allocFloats(2 * block);
+    pending.assign(block, 0.0f);
+    // Partition p holds taps [p B, (p + 1) B), zero-padded to 2B. The 1 / 2B
+    // of the unnormalized inverse transform is folded in here.
+    float scale = 1.0f / (2 * block);
+    for (size_t p = 0; p < partitions; p++) {
+        std::fill(frame, frame + 2 * block, 0.0f);
+        size_t end = std::min(ntaps, (p + 1) * block);
+        for (size_t k = p * block; k < end; k++) frame[k - p * block] = taps[k] * scale;
+        fftwf_execute_split_dft_r2c(forward, frame, kernel_re + p * stride, kernel_im + p * stride);
+    }
+    std::fill(frame, frame + 2 * block, 0.0f);
+}
+
+FirFilter::~FirFilter() {
+    for (float* p : {kernel_re, kernel_im, fdl_re, fdl_im, acc_re, acc_im, frame, result})
+        if (p) fftwf_free(p);
+}
+
+void FirFilter::reset() {
+    std::fill(history.begin(), history.end(), 0.0f);
+    if (!usesFft()) return;
+    size_t stride = binStride(block);
+    std::fill(fdl_re, fdl_re + partitions * stride, 0.0f);
+    std::fill(fdl_im, fdl_im + partitions * stride, 0.0f);
+    std::fill(frame, frame + 2 * block, 0.0f);
+    std::fill(pending.begin(), pending.end(), 0.0f);
+    fill = 0;
+    fdl_head = 0;
+}
+
+void FirFilter::process(const float* in, float* out, size_t n) {
+    if (!usesFft()) {
+        processDirect(in, out, n);
+        return;
+    }
+    size_t done = 0;
+    while (done < n) {
+        size_t m = std::min(n - done, block - fill);
+        // Take the inputs before writing over them when in == out.
+        std::copy(in + done, in + done + m, frame + block + fill);
+        std::copy(pending.begin() + fill, pending.begin() + fill + m, out + done);
+        fill += m;
+        done += m;
+        if (fill == block) {
+            processPartition();
+            fill = 0;
+        }
+    }
+}
+
+void FirFilter::processDirect(const float* in, float* out, size_t n) {
+    const DspKernels& k = dspKernels();
+    const size_t keep = ntaps - 1;
+    float buf[FIR_FFT_MIN_TAPS - 1 + FIR_DIRECT_BLOCK];
+    std::copy(history.begin(), history.end(), buf);
+    for (size_t i = 0; i < n; i += FIR_DIRECT_BLOCK) {
+        size_t m = std::min<size_t>(FIR_DIRECT_BLOCK, n - i);
+        std::copy(in + i, in + i + m, buf + keep);
+        k.fir(reversed.data(), ntaps, buf, out + i, m);
+        std::copy(buf + m, buf + m + keep, buf);
+    }
+    std::copy(buf, buf + keep, history.begin());
+}
+
+// One overlap-save step: transform the last 2B inputs into the newest delay
+// line slot, sum slot p times partition p, and keep the second half of the
+// inverse transform (the first half is circular wrap-around).
+void FirFilter::processPartition() {
+    const DspKernels& k = dspKernels();
+    size_t stride = binStride(block), bins = block + 1;
+    fftwf_execute_split_dft_r2c(forward, frame, fdl_re + fdl_head * stride, fdl_im + fdl_head * stride);
+    std::fill(acc_re, acc_re + bins, 0.0f);
+    std::fill(acc_im, acc_im + bins, 0.0f);
+    for (size_t p = 0; p < partitions; p++) {
+        size_t slot = (fdl_head + p) % partitions;
+        k.complexMulAdd(fdl_re + slot * stride, fdl_im + slot * stride, kernel_re + p * stride, kernel_im + p * stride,
+                        acc_re, acc_im, bins);
+    }
+    fftwf_execute_split_dft_c2r(inverse, acc_re, acc_im, result);
+    std::copy(result + block, result + 2 * block, pending.begin());
+    std::copy(frame + block, frame + 2 * block, frame);
+    fdl_head = (fdl_head + partitions - 1) % partitions;
+}
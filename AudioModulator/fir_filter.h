@@ -0,0 +1,67 @@
+#ifndef FIR_FILTER_H
+#define FIR_FILTER_H
+
+#include <fftw3.h>
+#include <cstddef>
+#include <vector>
+
+#define FIR_FFT_MIN_TAPS 128 // kernels at least this long are convolved through the FFT
+#define FIR_PARTITION 128    // FFT mode: partition length, block size and added latency
+#define FIR_DIRECT_BLOCK 256 // direct mode: samples per kernel pass
+
+// Blackman-windowed sinc with unit DC gain; cutoff in cycles per sample. A
+// cutoff of 0 gives all-zero taps.
+std::vector<float> designLowpassFir(int count, double cutoff);
+// Difference of two such lowpasses: passes low..high cycles per sample, or a
+// plain lowpass when low <= 0.
+std::vector<float> designBandpassFir(int count, double low, double high);
+
+// Streaming FIR filter for the real-time path. Short kernels run in direct
+// form through the SIMD fir kernel. From FIR_FFT_MIN_TAPS taps up the kernel
+// is cut into partitions of `partition` taps and convolved by uniformly
+// partitioned overlap-save: each input block is transformed once, pushed
+// into a frequency-domain delay line, and multiplied against every
+// partition's spectrum, so the cost grows with the kernel length only
+// through cheap complex multiply-adds. FFT mode delays the output by
+// `partition` samples on top of the filter's own delay; latency() reports it.
+class FirFilter {
+public:
+    explicit FirFilter(const std::vector<float>& taps, size_t partition = FIR_PARTITION);
+    ~FirFilter();
+    FirFilter(const FirFilter&) = delete;
+    FirFilter& operator=(const FirFilter&) = delete;
+
+    size_t size() const { return ntaps; }
+    bool usesFft() const { return partitions > 0; }
+    size_t latency() const { return usesFft() ? block : 0; }
+
+    // Any block size; in and out may be the same buffer.
+    void process(const float* in, float* out, size_t n);
+    void reset();
+
+private:
+    void processDirect(const float* in, float* out, size_t n);
+    void processPartition();
+
+    size_t ntaps;
+    // Direct form.
+    std::vector<float> reversed; // taps in reverse time order, for the fir kernel
+    std::vector<float> history;  // last ntaps - 1 inputs
+    // FFT form.
+    size_t block = 0;      // partition length B; FFT size is 2B, B + 1 bins
+    size_t partitions = 0; // 0 in direct mode
+    size_t fill = 0;       // samples in the current input block
+    size_t fdl_head = 0;   // delay line slot of the newest input spectrum
+    fftwf_plan forward = nullptr, inverse = nullptr;
+    float* kernel_re = nullptr; // partition spectra, (B + 1) bins each
+    float* kernel_im = nullptr;
+    float* fdl_re = nullptr;    // input spectra of the last `partitions` blocks
+    float* fdl_im = nullptr;
+    float* acc_re = nullptr;    // output spectrum
+    float* acc_im = nullptr;
+    float* frame = nullptr;     // 2B: previous input block, then the current one
+    float* result = nullptr;    // 2B: inverse transform, second half is valid
+    std::vector<float> pending; // B outputs of the last block, handed out as input arrives
+};
+
+#endif // FIR_FILTER_H
@@ -0,0 +1,109 @@
+#include "latency_stats.h"
+#include <algorithm>
+#include <fstream>
+
+// Single writer: a relaxed load/store pair is enough and avoids locked RMW.
+static inline void bump(std::atomic<uint64_t>& a, uint64_t by = 1) {
+    a.store(a.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+}
+
+LatencyRecorder::LatencyRecorder() {
+    for (std::atomic<uint64_t>& b : buckets) b.store(0);
+    count = max_ns = total_ns = total_budget_ns = deadline_misses = 0;
+    input_underflows = input_overflows = output_underflows = output_overflows = 0;
+    reset_requested = false;
+}
+
+int LatencyRecorder::bucketOf(uint64_t ns) {
+    if (ns < (1u << LATENCY_SUB_BITS)) return static_cast<int>(ns);
+    int e = 63;
+    while (!(ns >> e)) e--;
+    uint64_t mantissa = ns >> (e - LATENCY_SUB_BITS); // in [16, 32)
+    return ((e - LATENCY_SUB_BITS + 1) << LATENCY_SUB_BITS) + static_cast<int>(mantissa - (1u << LATENCY_SUB_BITS));
+}
+
+uint64_t LatencyRecorder::bucketUpperBound(int bucket) {
+    if (bucket < (1 << LATENCY_SUB_BITS)) return bucket;
+    int e = (bucket >> LATENCY_SUB_BITS) + LATENCY_SUB_BITS - 1;
+    uint64_t mantissa = (bucket & ((1 << LATENCY_SUB_BITS) - 1)) + (1u << LATENCY_SUB_BITS);
+    return ((mantissa + 1) << (e - LATENCY_SUB_BITS)) - 1;
+}
+
+void LatencyRecorder::record(uint64_t elapsed_ns, uint64_t budget_ns) {
+    if (reset_requested.load(std::memory_order_relaxed)) {
+        for (std::atomic<uint64_t>& b : buckets) b.store(0, std::memory_order_relaxed);
+        count = max_ns = total_ns = total_budget_ns = deadline_misses = 0;
+        input_underflows = input_overflows = output_underflows = output_overflows = 0;
+        reset_requested.store(false, std::memory_order_relaxed);
+    }
+    bump(buckets[bucketOf(elapsed_ns)]);
+    bump(total_ns, elapsed_ns);
+    bump(total_budget_ns, budget_ns);
+    if (elapsed_ns > max_ns.load(std::memory_order_relaxed)) max_ns.store(elapsed_ns, std::memory_order_relaxed);
+    if (elapsed_ns > budget_ns) bump(deadline_misses);
+    bump(count);
+}
+
+void LatencyRecorder::recordStatus(bool input_underflow, bool input_overflow, bool output_underflow,
+                                   bool output_overflow) {
+    if (input_underflow) bump(input_underflows);
+    if (input_overflow) bump(input_overflows);
+    if (output_underflow) bump(output_underflows);
+    if (output_overflow) bump(output_overflows);
+}
+
+uint64_t LatencyRecorder::percentile(double q, uint64_t total) const {
+    uint64_t target = static_cast<uint64_t>(q * total);
+    uint64_t seen = 0;
+    for (int b = 0; b < LATENCY_BUCKETS; b++) {
+        seen += buckets[b].load(std::memory_order_relaxed);
+        if (seen > target) return bucketUpperBound(b);
+    }
+    return max_ns.load(std::memory_order_relaxed);
+}
+
+LatencyRecorder::Snapshot LatencyRecorder::snapshot() const {
+    Snapshot s;
+    // Sum the buckets rather than trusting count, which may lag a concurrent record().
+    uint64_t total = 0;
+    for (const std::atomic<uint64_t>& b : buckets) total += b.load(std::memory_order_relaxed);
+    uint64_t max = max_ns.load(std::memory_order_relaxed);
+    s.count = total;
+    s.p50_ms = std::min(percentile(0.5, total), max) / 1e6;
+    s.p99_ms = std::min(percentile(0.99, total), max) / 1e6;
+    s.p999_ms = std::min(percentile(0.999, total), max) / 1e6;
+    s.max_ms = max / 1e6;
+    uint64_t budget = total_budget_ns.load(std::memory_order_relaxed);
+    s.load_percent = budget ? 100.0 * total_ns.load(std::memory_order_relaxed) / budget : 0.0;
+    s.deadline_misses = deadline_misses.load(std::memory_order_relaxed);
+    s.input_underflows = input_underflows.load(std::memory_order_relaxed);
+    s.input_overflows = input_overflows.load(std::memory_order_relaxed);
+    s.output_underflows = output_underflows.load(std::memory_order_relaxed);
+    s.output_overflows = output_overflows.load(std::memory_order_relaxed);
+    return s;
+}
+
+bool LatencyRecorder::dump(const char* path) const {
+    std::ofstream out(path);
+    if (!out) return false;
+    Snapshot s = snapshot();
+    out << "callbacks " << s.count << "\n"
+        << "p50_ms " << s.p50_ms << "\n"
+        << "p99_ms " << s.p99_ms << "\n"
+        << "p99.9_ms " << s.p999_ms << "\n"
+        << "max_ms " << s.max_ms << "\n"
+        << "load_percent " << s.load_percent << "\n"
+        << "deadline_misses " << s.deadline_misses << "\n"
+        << "input_underflows " << s.input_underflows << "\n"
+        << "input_overflows " << s.input_overflows << "\n"
+        << "output_underflows " << s.output_underflows << "\n"
+        << "output_overflows " << s.output_overflows << "\n"
+        << "# bucket_low_ns bucket_high_ns count\n";
+    for (int b = 0; b < LATENCY_BUCKETS; b++) {
+        uint64_t n = buckets[b].load(std::memory_order_relaxed);
+        if (n == 0) continue;
+        uint64_t low = b == 0 ? 0 : bucketUpperBound(b - 1) + 1;
+        out << low << " " << bucketUpperBound(b) << " " << n << "\n";
+    }
+    return static_cast<bool>(out);
+}
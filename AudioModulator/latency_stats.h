@@ -0,0 +1,45 @@
+#ifndef LATENCY_STATS_H
+#define LATENCY_STATS_H
+
+#include <atomic>
+#include <cstdint>
+
+#define LATENCY_SUB_BITS 4 // 16 sub-buckets per power of two, ~6% resolution
+#define LATENCY_BUCKETS ((64 - LATENCY_SUB_BITS + 1) << LATENCY_SUB_BITS)
+
+// Per-callback timing recorder. The audio thread is the only writer and only
+// does relaxed loads and stores into a fixed log-linear (HDR-style) histogram,
+// so recording is wait-free; any other thread can read a snapshot at any time.
+class LatencyRecorder {
+public:
+    struct Snapshot {
+        uint64_t count;
+        double p50_ms, p99_ms, p999_ms, max_ms;
+        double load_percent;     // time spent in callbacks / time available
+        uint64_t deadline_misses; // callbacks that took longer than their buffer lasts
+        uint64_t input_underflows, input_overflows, output_underflows, output_overflows;
+    };
+
+    LatencyRecorder();
+
+    // Audio thread.
+    void record(uint64_t elapsed_ns, uint64_t budget_ns);
+    void recordStatus(bool input_underflow, bool input_overflow, bool output_underflow, bool output_overflow);
+
+    // Any thread. reset() takes effect at the next record().
+    Snapshot snapshot() const;
+    void reset() { reset_requested.store(true, std::memory_order_relaxed); }
+    bool dump(const char* path) const;
+
+private:
+    static int bucketOf(uint64_t ns);
+    static uint64_t bucketUpperBound(int bucket);
+    uint64_t percentile(double q, uint64_t total) const;
+
+    std::atomic<uint64_t> buckets[LATENCY_BUCKETS];
+    std::atomic<uint64_t> count, max_ns, total_ns, total_budget_ns, deadline_misses;
+    std::atomic<uint64_t> input_underflows, input_overflows, output_underflows, output_overflows;
+    std::atomic<bool> reset_requested;
+};
+
+#endif // LATENCY_STATS_H
@@ -6,120 +6,71 @@
 #include <QWidget>
 #include <QTimer>
 #include <QLabel> // For metrics display
+#include <QComboBox>
+#include <QHBoxLayout>
 #include "qcustomplot.h"
 #include <sndfile.h>
-#include <fftw3.h>
 #include <chrono> // For timing
 #include <iostream>
 #include <cmath>
 #include <vector>
 #include <random>
-#define SAMPLE_RATE 44100
-#define BUFFER_SIZE 256
-#define ECHO_DELAY (SAMPLE_RATE / 4)
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include "modem.h"
+#include "channel_graph.h"
+#include "ring_buffer.h"
+#include "recorder.h"
+#include "batch.h"
+#include "latency_stats.h"
+#include "spectrum.h"
+#include "waterfall.h"
+
+#define SCOPE_SIZE 4096
+#define WISDOM_FILE "fftw_wisdom.dat"
+#define PLOT_INTERVAL_MS 33 // ~30 fps
 
 PaStream* stream;
-float carrier_freq = 10000.0f;
-float carrier_time = 0.0f;
-float phase = 0.0f;
-float last_sample = 0.0f;
-std::vector<float> modulated(BUFFER_SIZE);
-std::vector<float> demodulated(BUFFER_SIZE);
-float lowpass_state = 0.0f;
-std::string mode = "AM";
+std::unique_ptr<ChannelGraph> graph; // channel 0 is the one you hear
+SpscRingBuffer<float> scope_ring(1 << 16); // audio thread -> GUI
+std::unique_ptr<SpectrumAnalyzer> spectrum; // fed by the audio thread, run by the GUI
 float noise_level = 0.1f;
 std::random_device rd;
-std::mt19937 gen(rd());
-std::normal_distribution<float> noise(0.0f, noise_level);
-SNDFILE* wav_file = nullptr;
-SF_INFO sf_info = {0};
-bool is_recording = false;
-std::vector<float> echo_buffer(ECHO_DELAY, 0.0f);
-size_t echo_pos = 0;
+WavRecorder recorder;
 bool echo_enabled = false;
-double last_latency_ms = 0.0; // Store latency in ms
-double cpu_usage = 0.0;       // Approximate CPU usage
-
-float carrier(float amplitude) {
-    carrier_time += 1.0f / SAMPLE_RATE;
-    return amplitude * sinf(2 * M_PI * carrier_freq * carrier_time);
-}
-
-float modulateAM(float audio_sample) {
-    return (1.0f + audio_sample) * carrier(0.5f);
-}
-
-float modulateFM(float audio_sample) {
-    float freq_dev = 5000.0f;
-    phase += 2 * M_PI * (carrier_freq + audio_sample * freq_dev) / SAMPLE_RATE;
-    return sinf(phase);
-}
-
-float modulateQAM(float audio_sample) {
-    float I = audio_sample > 0 ? 1.0f : -1.0f;
-    float Q = (audio_sample > 0.5f || audio_sample < -0.5f) ? 1.0f : -1.0f;
-    carrier_time += 1.0f / SAMPLE_RATE;
-    float carrier_I = sinf(2 * M_PI * carrier_freq * carrier_time);
-    float carrier_Q = cosf(2 * M_PI * carrier_freq * carrier_time);
-    return 0.5f * (I * carrier_I + Q * carrier_Q);
-}
-
-float addNoise(float sample) {
-    return sample + noise(gen);
-}
-
-void demodAM(const std::vector<float>& in, std::vector<float>& out) {
-    const float alpha = 0.01f;
-    for (size_t i = 0; i < in.size(); i++) {
-        float rectified = fabs(in[i]);
-        lowpass_state = lowpass_state + alpha * (rectified - lowpass_state);
-        out[i] = lowpass_state - 0.5f;
-    }
-}
-
-void demodFM(const std::vector<float>& in, std::vector<float>& out) {
-    for (size_t i = 0; i < in.size(); i++) {
-        out[i] = (in[i] * last_sample) * SAMPLE_RATE;
-        last_sample = in[i];
-    }
-}
+LatencyRecorder latency; // callback timing, written only by the audio thread
 
-void demodQAM(const std::vector<float>& in, std::vector<float>& out) {
-    for (size_t i = 0; i < in.size(); i++) {
-        float carrier_I = sinf(2 * M_PI * carrier_freq * carrier_time);
-        float I = in[i] * carrier_I;
-        out[i] = I > 0 ? 0.5f : -0.5f;
-        carrier_time += 1.0f / SAMPLE_RATE;
-    }
+// Runs every chain once per block; callbacks larger than BUFFER_SIZE are
+// split so the scratch buffers never have to grow on the audio thread.
+void processChain(const float* in, float* out, size_t n) {
+    graph->process(in, n);
+    const float* demod = graph->demodulated(0);
+    std::copy(demod, demod + n, out);
+    scope_ring.push(demod, n);
+    spectrum->push(demod, n);
+    if (recorder.isRecording()) recorder.write(demod, n);
 }
 
 static int audioCallback(const void* input, void* output, unsigned long frameCount,
-                         const PaStreamCallbackTimeInfo*, PaStreamCallbackFlags, void*) {
+                         const PaStreamCallbackTimeInfo*, PaStreamCallbackFlags status, void*) {
     auto start = std::chrono::high_resolution_clock::now(); // Start timing
     const float* in = (const float*)input;
     float* out = (float*)output;
-    for (unsigned long i = 0; i < frameCount; i++) {
-        if (mode == "FM") modulated[i] = modulateFM(in[i]);
-        else if (mode == "QAM") modulated[i] = modulateQAM(in[i]);
-        else modulated[i] = modulateAM(in[i]);
-        modulated[i] = addNoise(modulated[i]);
-        if (mode == "FM") demodFM(modulated, demodulated);
-        else if (mode == "QAM") demodQAM(modulated, demodulated);
-        else demodAM(modulated, demodulated);
-        if (echo_enabled) {
-            float delayed = echo_buffer[echo_pos];
-            demodulated[i] = demodulated[i] + 0.5f * delayed;
-            echo_buffer[echo_pos] = demodulated[i];
-            echo_pos = (echo_pos + 1) % ECHO_DELAY;
-        }
-        out[i] = demodulated[i];
-    }
-    if (is_recording && wav_file) {
-        sf_write_float(wav_file, demodulated.data(), frameCount);
+    for (unsigned long done = 0; done < frameCount; done += BUFFER_SIZE) {
+        size_t n = std::min<unsigned long>(BUFFER_SIZE, frameCount - done);
+        processChain(in + done, out + done, n);
     }
     auto end = std::chrono::high_resolution_clock::now(); // End timing
-    last_latency_ms = std::chrono::duration<double, std::milli>(end - start).count();
-    cpu_usage = (last_latency_ms / (1000.0 / SAMPLE_RATE * frameCount)) * 100.0; // Rough CPU % estimate
+    // The callback misses its deadline if it runs longer than the buffer it fills lasts.
+    uint64_t elapsed_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    latency.record(elapsed_ns, frameCount * 1000000000ull / SAMPLE_RATE);
+    if (status)
+        latency.recordStatus(status & paInputUnderflow, status & paInputOverflow, status & paOutputUnderflow,
+                             status & paOutputOverflow);
     return paContinue;
 }
 
@@ -135,10 +86,7 @@ void cleanupAudio() {
         Pa_CloseStream(stream);
         Pa_Terminate();
     }
-    if (wav_file) {
-        sf_close(wav_file);
-        wav_file = nullptr;
-    }
+    recorder.stop();
 }
 
 class AudioWindow : public QWidget {
@@ -154,10 +102,25 @@ public:
         noiseSlider->setValue(10);
         recordButton = new QPushButton("Start Recording", this);
         echoButton = new QPushButton("Enable Echo", this);
-        metricsLabel = new QLabel("Latency: 0.0 ms, CPU: 0.0%", this); 
+        QPushButton* dumpButton = new QPushButton("Dump Latency", this);
+        QPushButton* resetButton = new QPushButton("Reset Latency", this);
+        metricsLabel = new QLabel("Latency: no callbacks yet", this);
+        QComboBox* fftSizeBox = new QComboBox(this);
+        for (int size = SPECTRUM_MIN_FFT; size <= SPECTRUM_MAX_FFT; size *= 2)
+            fftSizeBox->addItem(QString("FFT %1").arg(size), size);
+        fftSizeBox->setCurrentIndex(fftSizeBox->findData(static_cast<int>(spectrum->fftSize())));
+        QComboBox* windowBox = new QComboBox(this);
+        windowBox->addItems({"Hann", "Blackman"});
+        QComboBox* overlapBox = new QComboBox(this);
+        overlapBox->addItem("75% overlap", 0.75);
+        overlapBox->addItem("50% overlap", 0.5);
+        QComboBox* averagingBox = new QComboBox(this);
+        averagingBox->addItems({"Exponential average", "Peak hold", "No averaging"});
         waveformPlot = new QCustomPlot(this);
-        waveformPlot->addGraph();
-        waveformPlot->xAxis->setRange(0, BUFFER_SIZE);
+        // Views scope_history directly; a replot is all it takes to show new samples.
+        QCPSampleGraph* scope = new QCPSampleGraph(waveformPlot->xAxis, waveformPlot->yAxis);
+        scope->setSamples(scope_history.data(), SCOPE_SIZE);
+        waveformPlot->xAxis->setRange(0, SCOPE_SIZE);
         waveformPlot->yAxis->setRange(-1, 1);
         waveformPlot->setMinimumHeight(200);
         spectrumPlot = new QCustomPlot(this);
@@ -165,6 +128,9 @@ public:
         spectrumPlot->xAxis->setRange(0, SAMPLE_RATE / 2);
         spectrumPlot->yAxis->setRange(0, 1);
         spectrumPlot->setMinimumHeight(200);
+        waterfallPlot = new QCustomPlot(this);
+        waterfallPlot->setMinimumHeight(300);
+        waterfall.reset(new Waterfall(waterfallPlot, PLOT_INTERVAL_MS / 1000.0));
 
         layout->addWidget(amButton);
         layout->addWidget(fmButton);
@@ -173,8 +139,17 @@ public:
         layout->addWidget(recordButton);
         layout->addWidget(echoButton);
         layout->addWidget(metricsLabel);
+        layout->addWidget(dumpButton);
+        layout->addWidget(resetButton);
         layout->addWidget(waveformPlot);
+        QHBoxLayout* spectrumControls = new QHBoxLayout;
+        spectrumControls->addWidget(fftSizeBox);
+        spectrumControls->addWidget(windowBox);
+        spectrumControls->addWidget(overlapBox);
+        spectrumControls->addWidget(averagingBox);
+        layout->addLayout(spectrumControls);
         layout->addWidget(spectrumPlot);
+        layout->addWidget(waterfallPlot);
         setLayout(layout);
 
         connect(amButton, &QPushButton::clicked, this, &AudioWindow::setAM);
@@ -183,103 +158,156 @@ public:
         connect(noiseSlider, &QSlider::valueChanged, this, &AudioWindow::setNoise);
         connect(recordButton, &QPushButton::clicked, this, &AudioWindow::toggleRecord);
         connect(echoButton, &QPushButton::clicked, this, &AudioWindow::toggleEcho);
+        connect(dumpButton, &QPushButton::clicked, this, &AudioWindow::dumpLatency);
+        connect(resetButton, &QPushButton::clicked, this, [] { latency.reset(); });
+        connect(fftSizeBox, static_cast<void (QComboBox::*)(int)>(&QComboBox::currentIndexChanged), this,
+                [fftSizeBox](int i) { spectrum->setFftSize(fftSizeBox->itemData(i).toInt()); });
+        connect(windowBox, static_cast<void (QComboBox::*)(int)>(&QComboBox::currentIndexChanged), this,
+                [](int i) { spectrum->setWindow(i == 0 ? Window::Hann : Window::Blackman); });
+        connect(overlapBox, static_cast<void (QComboBox::*)(int)>(&QComboBox::currentIndexChanged), this,
+                [overlapBox](int i) { spectrum->setOverlap(overlapBox->itemData(i).toDouble()); });
+        connect(averagingBox, static_cast<void (QComboBox::*)(int)>(&QComboBox::currentIndexChanged), this,
+                [](int i) {
+                    if (i == 0) spectrum->setAveraging(Averaging::Exponential, 0.25);
+                    else if (i == 1) spectrum->setAveraging(Averaging::Peak, 0.98);
+                    else spectrum->setAveraging(Averaging::None, 0.0);
+                });
 
         QTimer* timer = new QTimer(this);
         connect(timer, &QTimer::timeout, this, &AudioWindow::updatePlots);
-        timer->start(50);
-
-        sf_info.channels = 1;
-        sf_info.samplerate = SAMPLE_RATE;
-        sf_info.format = SF_FORMAT_WAV | SF_FORMAT_FLOAT;
-
-        fft_in = (double*)fftw_malloc(sizeof(double) * BUFFER_SIZE);
-        fft_out = (fftw_complex*)fftw_malloc(sizeof(fftw_complex) * (BUFFER_SIZE / 2 + 1));
-        fft_plan = fftw_plan_dft_r2c_1d(BUFFER_SIZE, fft_in, fft_out, FFTW_ESTIMATE);
+        timer->start(PLOT_INTERVAL_MS);
     }
     ~AudioWindow() {
-        fftw_destroy_plan(fft_plan);
-        fftw_free(fft_in);
-        fftw_free(fft_out);
         cleanupAudio();
     }
 
 private slots:
-    void setAM() { mode = "AM"; std::cout << "Switched to AM\n"; }
-    void setFM() { mode = "FM"; std::cout << "Switched to FM\n"; }
-    void setQAM() { mode = "QAM"; std::cout << "Switched to QAM\n"; }
-    void setNoise(int value) { 
-        noise_level = value / 100.0f; 
-        noise = std::normal_distribution<float>(0.0f, noise_level); 
+    void setAM() { setMode(Mode::AM); std::cout << "Switched to AM\n"; }
+    void setFM() { setMode(Mode::FM); std::cout << "Switched to FM\n"; }
+    void setQAM() { setMode(Mode::QAM); std::cout << "Switched to QAM\n"; }
+    void setNoise(int value) {
+        noise_level = value / 100.0f;
+        for (size_t c = 0; c < graph->channelCount(); c++) graph->setNoiseLevel(c, noise_level);
         std::cout << "Noise level set to " << noise_level << "\n";
     }
     void toggleRecord() {
-        if (!is_recording) {
-            wav_file = sf_open("output.wav", SFM_WRITE, &sf_info);
-            if (!wav_file) {
+        if (!recorder.isRecording()) {
+            if (!recorder.start("output.wav", SAMPLE_RATE)) {
                 std::cout << "Failed to open output.wav: " << sf_strerror(nullptr) << "\n";
                 return;
             }
-            is_recording = true;
             recordButton->setText("Stop Recording");
             std::cout << "Recording started\n";
         } else {
-            sf_close(wav_file);
-            wav_file = nullptr;
-            is_recording = false;
+            recorder.stop();
             recordButton->setText("Start Recording");
             std::cout << "Recording stopped\n";
+            if (recorder.droppedSamples() > 0)
+                std::cout << "Recorder dropped " << recorder.droppedSamples() << " samples\n";
         }
     }
     void toggleEcho() {
         echo_enabled = !echo_enabled;
+        for (size_t c = 0; c < graph->channelCount(); c++) graph->setEcho(c, echo_enabled);
         echoButton->setText(echo_enabled ? "Disable Echo" : "Enable Echo");
         std::cout << (echo_enabled ? "Echo enabled\n" : "Echo disabled\n");
     }
+    void dumpLatency() {
+        if (latency.dump("latency.txt"))
+            std::cout << "Latency histogram written to latency.txt\n";
+        else
+            std::cout << "Failed to write latency.txt\n";
+    }
     void updatePlots() {
-        QVector<double> x(BUFFER_SIZE), y(BUFFER_SIZE);
-        for (int i = 0; i < BUFFER_SIZE; i++) {
-            x[i] = i;
-            y[i] = demodulated[i];
+        // Keep the newest SCOPE_SIZE samples, oldest first.
+        size_t n;
+        while ((n = scope_ring.pop(scope_chunk.data(), scope_chunk.size())) > 0) {
+            std::copy(scope_history.begin() + n, scope_history.end(), scope_history.begin());
+            std::copy(scope_chunk.begin(), scope_chunk.begin() + n, scope_history.end() - n);
         }
-        waveformPlot->graph(0)->setData(x, y);
         waveformPlot->replot();
 
-        for (int i = 0; i < BUFFER_SIZE; i++) {
-            fft_in[i] = demodulated[i];
-        }
-        fftw_execute(fft_plan);
-        QVector<double> freq(BUFFER_SIZE / 2), mag(BUFFER_SIZE / 2);
-        for (int i = 0; i < BUFFER_SIZE / 2; i++) {
-            freq[i] = i * SAMPLE_RATE / BUFFER_SIZE;
-            mag[i] = sqrt(fft_out[i][0] * fft_out[i][0] + fft_out[i][1] * fft_out[i][1]) / BUFFER_SIZE;
+        if (spectrum->process() > 0) {
+            const std::vector<double>& mag = spectrum->magnitude();
+            QVector<double> freq(mag.size()), amp(mag.size());
+            for (size_t i = 0; i < mag.size(); i++) {
+                freq[i] = spectrum->binFrequency(i);
+                amp[i] = mag[i];
+            }
+            spectrumPlot->graph(0)->setData(freq, amp, true);
+            spectrumPlot->replot();
+            waterfall->addSpectrum(mag, SAMPLE_RATE / 2.0);
+            waterfallPlot->replot();
         }
-        spectrumPlot->graph(0)->setData(freq, mag);
-        spectrumPlot->replot();
 
 
-        metricsLabel->setText(QString("Latency: %1 ms, CPU: %2%")
-                              .arg(last_latency_ms, 0, 'f', 1)
-                              .arg(cpu_usage, 0, 'f', 1));
+        LatencyRecorder::Snapshot stats = latency.snapshot();
+        metricsLabel->setText(QString("Latency p50 %1 / p99 %2 / p99.9 %3 / max %4 ms, CPU: %5%\n"
+                                      "Deadline misses: %6, xruns in %7/%8 out %9/%10 (under/over)")
+                              .arg(stats.p50_ms, 0, 'f', 2)
+                              .arg(stats.p99_ms, 0, 'f', 2)
+                              .arg(stats.p999_ms, 0, 'f', 2)
+                              .arg(stats.max_ms, 0, 'f', 2)
+                              .arg(stats.load_percent, 0, 'f', 1)
+                              .arg(stats.deadline_misses)
+                              .arg(stats.input_underflows)
+                              .arg(stats.input_overflows)
+                              .arg(stats.output_underflows)
+                              .arg(stats.output_overflows));
     }
 
 private:
+    void setMode(Mode m) {
+        for (size_t c = 0; c < graph->channelCount(); c++) graph->setMode(c, m);
+    }
+
     QCustomPlot* waveformPlot;
     QCustomPlot* spectrumPlot;
+    QCustomPlot* waterfallPlot;
+    std::unique_ptr<Waterfall> waterfall;
     QPushButton* recordButton;
     QPushButton* echoButton;
     QLabel* metricsLabel; 
-    double* fft_in;
-    fftw_complex* fft_out;
-    fftw_plan fft_plan;
+    std::vector<float> scope_history = std::vector<float>(SCOPE_SIZE, 0.0f);
+    std::vector<float> scope_chunk = std::vector<float>(SCOPE_SIZE);
 };
 
 int main(int argc, char* argv[]) {
+    if (argc > 1 && strcmp(argv[1], "--batch") == 0) return runBatch(argc - 2, argv + 2);
+    size_t channel_count = 1;
+    size_t worker_count = std::thread::hardware_concurrency();
+    int oversample = 1;
+    int channel_fir = 0, post_fir = 0;
+    float rx_offset = 0.0f;
+    for (int i = 1; i + 1 < argc; i++) {
+        if (strcmp(argv[i], "--channels") == 0) channel_count = std::max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--workers") == 0) worker_count = std::max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--oversample") == 0) oversample = std::max(1, std::min(OVERSAMPLE_MAX, atoi(argv[++i])));
+        else if (strcmp(argv[i], "--channel-fir") == 0) channel_fir = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--post-fir") == 0) post_fir = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--rx-offset") == 0) rx_offset = static_cast<float>(atof(argv[++i]));
+    }
+    graph.reset(new ChannelGraph(channel_count, worker_count, BUFFER_SIZE));
+    // FFTW_MEASURE planning is slow the first time; wisdom makes later runs start instantly.
+    SpectrumAnalyzer::loadWisdom(WISDOM_FILE);
+    spectrum.reset(new SpectrumAnalyzer(SAMPLE_RATE));
+    for (size_t c = 0; c < channel_count; c++) {
+        graph->state(c).noise.seed((static_cast<uint64_t>(rd()) << 32) | rd());
+        setOversampling(graph->state(c), oversample);
+        setChannelFilter(graph->state(c), channel_fir);
+        setPostFilter(graph->state(c), post_fir);
+        setReceiverOffset(graph->state(c), rx_offset);
+    }
+    std::cout << "Channels: " << channel_count << " on " << graph->workerCount() << " worker(s)\n";
+    std::cout << "Modem rate: " << oversample << "x " << SAMPLE_RATE << " Hz\n";
+    std::cout << "DSP kernels: " << dspKernels().name << "\n";
     initAudio();
     QApplication app(argc, argv);
     AudioWindow window;
     window.show();
     int result = app.exec();
     cleanupAudio();
+    SpectrumAnalyzer::saveWisdom(WISDOM_FILE);
     return result;
 }
 
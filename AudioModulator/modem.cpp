@@ -0,0 +1,362 @@
+#include "modem.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+void setCarrierFrequency(ModemState& s, float freq) {
+    s.carrier_freq = freq;
+    s.tx_carrier.setFrequency(freq, modemRate(s));
+    s.rx_carrier.setFrequency(freq + s.rx_offset, modemRate(s));
+    if (s.channel_filter) setChannelFilter(s, static_cast<int>(s.channel_filter->size()));
+}
+
+// IF lowpass length: the transition band stays the same width in Hz, so the
+// filter grows with the rate.
+static int fmIfTapCount(int oversample) {
+    return (FM_IF_TAPS - 1) * oversample + 1;
+}
+
+void setReceiverOffset(ModemState& s, float offset) {
+    s.rx_offset = offset;
+    setCarrierFrequency(s, static_cast<float>(s.carrier_freq));
+}
+
+void setOversampling(ModemState& s, int factor) {
+    s.oversample = std::max(1, std::min(OVERSAMPLE_MAX, factor));
+    double rate = modemRate(s);
+    setCarrierFrequency(s, static_cast<float>(s.carrier_freq));
+    // Same time constants in seconds at the new rate.
+    s.am_filter = designButterworthLowpass(AM_SECTIONS, AM_CUTOFF / rate);
+    std::fill(s.am_state.begin(), s.am_state.end(), 0.0f);
+    s.deemphasis = makeOnePole(fmEmphasisAlpha(rate));
+    s.deemphasis_state = 0.0f;
+    s.fm_pre_last = 0.0f;
+    for (std::vector<float>& h : s.fm_history) h.assign(fmIfTapCount(s.oversample) - 1, 0.0f);
+    s.fm_last_i = 1.0f;
+    s.fm_last_q = 0.0f;
+    s.qam_frame_pos = 0;
+    s.qam_loop = CarrierLoop();
+    s.upsampler = PolyphaseInterpolator(s.oversample);
+    s.mod_decimator = PolyphaseDecimator(s.oversample);
+    s.demod_decimator = PolyphaseDecimator(s.oversample);
+}
+
+void modulateAM(ModemState& s, const float* in, float* out, size_t n) {
+    const DspKernels& k = dspKernels();
+    float carrier[KERNEL_BLOCK];
+    for (size_t i = 0; i < n; i += KERNEL_BLOCK) {
+        size_t m = std::min<size_t>(KERNEL_BLOCK, n - i);
+        s.tx_carrier.fill(carrier, m);
+        k.mixAM(in + i, carrier, out + i, m);
+    }
+}
+
+void modulateFM(ModemState& s, const float* in, float* out, size_t n) {
+    const float dev_scale = FM_DEVIATION / modemRate(s) * 4294967296.0; // phase units per unit input
+    // Pre-emphasis (x[n] - a x[n-1]) / (1 - a), undone by the receiver's de-emphasis.
+    const float a = 1.0f - fmEmphasisAlpha(modemRate(s));
+    const float pre_gain = 1.0f / (1.0f - a);
+    const DspKernels& k = dspKernels();
+    uint32_t phase[KERNEL_BLOCK];
+    uint32_t acc = s.tx_carrier.phase();
+    uint32_t inc = s.tx_carrier.phaseIncrement();
+    float last = s.fm_pre_last;
+    for (size_t i = 0; i < n; i += KERNEL_BLOCK) {
+        size_t m = std::min<size_t>(KERNEL_BLOCK, n - i);
+        for (size_t j = 0; j < m; j++) {
+            float x = (in[i + j] - a * last) * pre_gain;
+            last = in[i + j];
+            x = std::max(-1.0f, std::min(1.0f, x));
+            acc += inc + static_cast<uint32_t>(static_cast<int32_t>(x * dev_scale));
+            phase[j] = acc;
+        }
+        k.sineOf(phase, s.tx_carrier.sineTable(), out + i, m);
+    }
+    s.tx_carrier.setPhase(acc);
+    s.fm_pre_last = last;
+}
+
+// Every QAM_FRAME samples the audio gives way to a phase marker: the carrier
+// switched off, then the reference symbol I = Q = +1. A constant-envelope
+// QPSK signal never goes quiet, so the receiver finds markers on its own and
+// reads the quarter turn its loop locked at from the reference.
+void modulateQAM(ModemState& s, const float* in, float* out, size_t n) {
+    const DspKernels& k = dspKernels();
+    const size_t frame = QAM_FRAME * s.oversample, gap = QAM_MARKER_GAP * s.oversample;
+    const size_t marker = gap + QAM_MARKER_REF * s.oversample;
+    float carrier_I[KERNEL_BLOCK], carrier_Q[KERNEL_BLOCK];
+    for (size_t i = 0; i < n; i += KERNEL_BLOCK) {
+        size_t m = std::min<size_t>(KERNEL_BLOCK, n - i);
+        s.tx_carrier.fill(carrier_I, carrier_Q, m);
+        k.mixQAM(in + i, carrier_I, carrier_Q, out + i, m);
+        for (size_t t = 0; t < m;) {
+            if (s.qam_frame_pos < marker) {
+                out[i + t] = s.qam_frame_pos < gap ? 0.0f : 0.5f * (carrier_I[t] + carrier_Q[t]);
+                s.qam_frame_pos++;
+                t++;
+            } else {
+                size_t run = std::min(m - t, frame - s.qam_frame_pos);
+                s.qam_frame_pos = (s.qam_frame_pos + run) % frame;
+                t += run;
+            }
+        }
+    }
+}
+
+void setChannelFilter(ModemState& s, int taps) {
+    if (taps <= 0) {
+        s.channel_filter.reset();
+        return;
+    }
+    double rate = modemRate(s);
+    double low = std::max(0.0, s.carrier_freq - CHANNEL_HALF_BANDWIDTH) / rate;
+    double high = std::min(rate / 2, s.carrier_freq + CHANNEL_HALF_BANDWIDTH) / rate;
+    s.channel_filter.reset(new FirFilter(designBandpassFir(taps, low, high)));
+}
+
+void setPostFilter(ModemState& s, int taps) {
+    if (taps <= 0) {
+        s.post_filter.reset();
+        return;
+    }
+    s.post_filter.reset(new FirFilter(designLowpassFir(taps, POST_FILTER_CUTOFF / SAMPLE_RATE)));
+}
+
+void addNoise(ModemState& s, float* buf, size_t n) {
+    s.noise.addTo(buf, n);
+}
+
+void filterChannel(ModemState& s, float* buf, size_t n) {
+    if (s.channel_filter) s.channel_filter->process(buf, buf, n);
+}
+
+void filterAudio(ModemState& s, float* buf, size_t n) {
+    if (s.post_filter) s.post_filter->process(buf, buf, n);
+}
+
+void demodAM(ModemState& s, const float* in, float* out, size_t n) {
+    ModemState* chain = &s;
+    demodAMLanes(&chain, &in, &out, 1, n);
+}
+
+// Lanes a lane-parallel kernel runs `count` chains in: padded to whole vectors
+// with idle lanes, except that one or two leftover chains run in the kernel's
+// scalar tail. A vector step costs two to three scalar ones, so a lone chain
+// (demodAM, demodQAM) never pays for a whole vector.
+static size_t paddedLanes(size_t count) {
+    const size_t width = dspKernels().width, rem = count % width;
+    return rem > 2 ? count - rem + width : count;
+}
+
+// Envelope detection: rectify, lowpass, and undo the 0.5 * (1 + audio) * |sin|
+// scaling (the mean of |sin| is 2 / pi). Each chain's coefficients and state
+// are gathered into one lane of the SoA layout the kernel wants and scattered
+// back afterwards. Idle padding lanes have zero coefficients, so they stay
+// zero.
+void demodAMLanes(ModemState* const* s, const float* const* in, float* const* out, size_t count, size_t n) {
+    const DspKernels& k = dspKernels();
+    const float gain = static_cast<float>(M_PI);
+    const size_t lanes = paddedLanes(count);
+    // Scratch is laid out with a stride of `lanes`; only the idle lanes need
+    // clearing, once, since the kernel keeps them at zero.
+    float coeffs[AM_SECTIONS * 5 * CHANNEL_LANES], state[AM_SECTIONS * 2 * CHANNEL_LANES];
+    float frames[KERNEL_BLOCK * CHANNEL_LANES];
+    for (size_t c = count; c < lanes; c++) {
+        for (int row = 0; row < AM_SECTIONS * 5; row++) coeffs[row * lanes + c] = 0.0f;
+        for (int row = 0; row < AM_SECTIONS * 2; row++) state[row * lanes + c] = 0.0f;
+        for (size_t t = 0; t < KERNEL_BLOCK; t++) frames[t * lanes + c] = 0.0f;
+    }
+    for (size_t c = 0; c < count; c++) {
+        for (int sec = 0; sec < AM_SECTIONS; sec++) {
+            const Biquad& b = s[c]->am_filter[sec];
+            float* dst = coeffs + sec * 5 * lanes + c;
+            dst[0] = b.b0;
+            dst[lanes] = b.b1;
+            dst[2 * lanes] = b.b2;
+            dst[3 * lanes] = b.a1;
+            dst[4 * lanes] = b.a2;
+            state[(2 * sec) * lanes + c] = s[c]->am_state[2 * sec];
+            state[(2 * sec + 1) * lanes + c] = s[c]->am_state[2 * sec + 1];
+        }
+    }
+    for (size_t i = 0; i < n; i += KERNEL_BLOCK) {
+        size_t m = std::min<size_t>(KERNEL_BLOCK, n - i);
+        for (size_t c = 0; c < count; c++)
+            for (size_t t = 0; t < m; t++) frames[t * lanes + c] = std::fabs(in[c][i + t]);
+        k.biquadCascade(coeffs, state, AM_SECTIONS, lanes, frames, frames, m);
+        for (size_t c = 0; c < count; c++)
+            for (size_t t = 0; t < m; t++) out[c][i + t] = frames[t * lanes + c] * gain - 1.0f;
+    }
+    for (size_t c = 0; c < count; c++) {
+        for (int sec = 0; sec < AM_SECTIONS; sec++) {
+            s[c]->am_state[2 * sec] = state[(2 * sec) * lanes + c];
+            s[c]->am_state[2 * sec + 1] = state[(2 * sec + 1) * lanes + c];
+        }
+    }
+}
+
+void processBlockLanes(Mode mode, ModemState* const* s, const float* in, float* const* mod, float* const* demod,
+                       size_t count, size_t n) {
+    for (size_t c = 0; c < count; c++) {
+        switch (mode) {
+        case Mode::FM: modulateFM(*s[c], in, mod[c], n); break;
+        case Mode::QAM: modulateQAM(*s[c], in, mod[c], n); break;
+        default: modulateAM(*s[c], in, mod[c], n); break;
+        }
+        addNoise(*s[c], mod[c], n);
+        filterChannel(*s[c], mod[c], n);
+    }
+    if (mode == Mode::AM) {
+        demodAMLanes(s, mod, demod, count, n);
+    } else if (mode == Mode::QAM) {
+        demodQAMLanes(s, mod, demod, count, n);
+    } else {
+        for (size_t c = 0; c < count; c++) demodFM(*s[c], mod[c], demod[c], n);
+    }
+    for (size_t c = 0; c < count; c++) filterAudio(*s[c], demod[c], n);
+}
+
+// Blackman-windowed sinc, cutoff 10 kHz: passes the FM signal shifted to
+// 0 Hz (deviation plus audio bandwidth) and stops the image at twice the
+// carrier. One filter per oversampling factor.
+static const float* fmIfTaps(int oversample) {
+    static const std::vector<std::vector<float>> taps = [] {
+        std::vector<std::vector<float>> all(OVERSAMPLE_MAX + 1);
+        for (int f = 1; f <= OVERSAMPLE_MAX; f++)
+            all[f] = designLowpassFir(fmIfTapCount(f), 10000.0 / (static_cast<double>(SAMPLE_RATE) * f));
+        return all;
+    }();
+    return taps[oversample].data();
+}
+
+// Quadrature downmix to I/Q, IF lowpass, then the phase step between
+// consecutive I/Q samples is the instantaneous frequency.
+void demodFM(ModemState& s, const float* in, float* out, size_t n) {
+    const int ntaps = fmIfTapCount(s.oversample);
+    const int history = ntaps - 1;
+    const float gain = modemRate(s) / (2 * M_PI * FM_DEVIATION); // rad/sample to audio units
+    const DspKernels& k = dspKernels();
+    const float* taps = fmIfTaps(s.oversample);
+    float sin_c[KERNEL_BLOCK], cos_c[KERNEL_BLOCK];
+    float mixed[2][(FM_IF_TAPS - 1) * OVERSAMPLE_MAX + KERNEL_BLOCK];
+    float base[2][1 + KERNEL_BLOCK]; // led by the last sample of the previous block
+    for (size_t i = 0; i < n; i += KERNEL_BLOCK) {
+        size_t m = std::min<size_t>(KERNEL_BLOCK, n - i);
+        s.rx_carrier.fill(sin_c, cos_c, m);
+        k.downmix(in + i, sin_c, cos_c, mixed[0] + history, mixed[1] + history, m);
+        base[0][0] = s.fm_last_i;
+        base[1][0] = s.fm_last_q;
+        for (int c = 0; c < 2; c++) {
+            std::copy(s.fm_history[c].begin(), s.fm_history[c].end(), mixed[c]);
+            k.fir(taps, ntaps, mixed[c], base[c] + 1, m);
+            std::copy(mixed[c] + m, mixed[c] + m + history, s.fm_history[c].begin());
+        }
+        k.fmDiscriminate(base[0] + 1, base[1] + 1, gain, out + i, m);
+        s.fm_last_i = base[0][m];
+        s.fm_last_q = base[1][m];
+    }
+    k.lowpass(out, out, s.deemphasis, &s.deemphasis_state, n);
+}
+
+void demodQAM(ModemState& s, const float* in, float* out, size_t n) {
+    ModemState* chain = &s;
+    demodQAMLanes(&chain, &in, &out, 1, n);
+}
+
+// Second-order loop of QAM_LOOP_BANDWIDTH (damping 0.707) around a phase
+// detector whose gain is pi per cycle of error, with the arms cut off at
+// QAM_ARM_CUTOFF. Everything is per sample, so it depends on the rate.
+static CostasParams qamLoopParams(const ModemState& s) {
+    const double rate = modemRate(s), zeta = 0.7071, detector_gain = M_PI;
+    double theta = QAM_LOOP_BANDWIDTH / rate / (zeta + 0.25 / zeta);
+    double norm = 1 + 2 * zeta * theta + theta * theta;
+    CostasParams g;
+    g.arm_alpha = static_cast<float>(1 - exp(-2 * M_PI * QAM_ARM_CUTOFF / rate));
+    g.kp = static_cast<float>(4 * zeta * theta / (norm * detector_gain));
+    g.ki = static_cast<float>(4 * theta * theta / (norm * detector_gain));
+    // Locked arms sum to about 0.5, so a run well below that is the marker
+    // gap. The reference symbol after it is summed over its middle, clear of
+    // the level smoothing and the arm filter delay.
+    const int ref_len = QAM_MARKER_REF * s.oversample;
+    g.level_alpha = 1.0f / (8 * s.oversample);
+    g.level_threshold = 0.3f;
+    g.quiet_min = QAM_MARKER_GAP / 2 * s.oversample;
+    g.ref_begin = ref_len / 8;
+    g.ref_end = ref_len / 2;
+    g.ref_stop = ref_len - ref_len / 8;
+    return g;
+}
+
+// Carrier recovery: every chain runs its own Costas loop, locked to what it
+// receives rather than to the transmitter. Loops are gathered into the lanes
+// of one CostasLanes, padded like demodAMLanes.
+void demodQAMLanes(ModemState* const* s, const float* const* in, float* const* out, size_t count, size_t n) {
+    const DspKernels& k = dspKernels();
+    const size_t lanes = paddedLanes(count);
+    const CostasParams g = qamLoopParams(*s[0]);
+    // Idle lanes track a silent input with a zero step; clearing them once
+    // keeps them finite, and only they need it.
+    CostasLanes loops;
+    float frames[KERNEL_BLOCK * CHANNEL_LANES];
+    for (size_t c = count; c < lanes; c++) {
+        loops.phase[c] = loops.inc[c] = 0;
+        loops.arm_i[c] = loops.arm_q[c] = loops.freq[c] = 0.0f;
+        loops.level[c] = loops.quiet[c] = loops.ref_i[c] = loops.ref_q[c] = 0.0f;
+        loops.ref_pos[c] = -1.0f;
+        loops.rot_c[c] = 1.0f;
+        loops.rot_s[c] = loops.last_out[c] = 0.0f;
+        for (size_t t = 0; t < KERNEL_BLOCK; t++) frames[t * lanes + c] = 0.0f;
+    }
+    for (size_t c = 0; c < count; c++) {
+        const CarrierLoop& loop = s[c]->qam_loop;
+        loops.phase[c] = loop.phase;
+        loops.inc[c] = s[c]->rx_carrier.phaseIncrement();
+        loops.arm_i[c] = loop.arm_i;
+        loops.arm_q[c] = loop.arm_q;
+        loops.freq[c] = loop.freq;
+        loops.level[c] = loop.level;
+        loops.quiet[c] = loop.quiet;
+        loops.ref_pos[c] = loop.ref_pos;
+        loops.ref_i[c] = loop.ref_i;
+        loops.ref_q[c] = loop.ref_q;
+        loops.rot_c[c] = loop.rot_c;
+        loops.rot_s[c] = loop.rot_s;
+        loops.last_out[c] = loop.last_out;
+    }
+    for (size_t i = 0; i < n; i += KERNEL_BLOCK) {
+        size_t m = std::min<size_t>(KERNEL_BLOCK, n - i);
+        for (size_t c = 0; c < count; c++)
+            for (size_t t = 0; t < m; t++) frames[t * lanes + c] = in[c][i + t];
+        k.costas(loops, g, s[0]->rx_carrier.sineTable(), lanes, frames, frames, m);
+        for (size_t c = 0; c < count; c++)
+            for (size_t t = 0; t < m; t++) out[c][i + t] = frames[t * lanes + c];
+    }
+    for (size_t c = 0; c < count; c++) {
+        CarrierLoop& loop = s[c]->qam_loop;
+        loop.phase = loops.phase[c];
+        loop.arm_i = loops.arm_i[c];
+        loop.arm_q = loops.arm_q[c];
+        loop.freq = loops.freq[c];
+        loop.level = loops.level[c];
+        loop.quiet = loops.quiet[c];
+        loop.ref_pos = loops.ref_pos[c];
+        loop.ref_i = loops.ref_i[c];
+        loop.ref_q = loops.ref_q[c];
+        loop.rot_c = loops.rot_c[c];
+        loop.rot_s = loops.rot_s[c];
+        loop.last_out = loops.last_out[c];
+    }
+}
+
+void applyEcho(ModemState& s, float* buf, size_t n) {
+    // The delay line is longer than any block, so each contiguous run of it
+    // can be mixed in one pass.
+    const DspKernels& k = dspKernels();
+    size_t done = 0;
+    while (done < n) {
+        size_t m = std::min(n - done, ECHO_DELAY - s.echo_pos);
+        k.echo(buf + done, s.echo_buffer.data() + s.echo_pos, 0.5f, m);
+        s.echo_pos = (s.echo_pos + m) % ECHO_DELAY;
+        done += m;
+    }
+}
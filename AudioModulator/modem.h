@@ -0,0 +1,176 @@
+#ifndef MODEM_H
+#define MODEM_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include "nco.h"
+#include "dsp_kernels.h"
+#include "fir_filter.h"
+#include "noise.h"
+#include "resampler.h"
+
+#define SAMPLE_RATE 44100
+#define BUFFER_SIZE 256
+#define ECHO_DELAY (SAMPLE_RATE / 4)
+#define KERNEL_BLOCK 256 // scratch size for stages that need intermediate buffers
+#define FM_DEVIATION 5000.0f // Hz at full-scale audio
+#define FM_EMPHASIS_TAU 50e-6 // pre-/de-emphasis time constant, seconds
+#define FM_IF_TAPS 63 // I/Q lowpass after the receiver downmix, at 1x oversampling
+#define AM_SECTIONS 2 // envelope lowpass: Butterworth of order 2 * AM_SECTIONS
+#define AM_CUTOFF 5000.0 // envelope lowpass cutoff, Hz
+#define QAM_LOOP_BANDWIDTH 200.0 // carrier recovery loop noise bandwidth, Hz
+#define QAM_ARM_CUTOFF 3000.0 // Costas arm lowpass cutoff, Hz
+#define QAM_FRAME 8192 // samples from one carrier phase marker to the next, at 1x oversampling
+#define QAM_MARKER_GAP 64 // marker: carrier off for this many samples,
+#define QAM_MARKER_REF 32 // then the reference symbol I = Q = +1 for this many
+#define CHANNEL_HALF_BANDWIDTH 8000.0 // channel filter passband: carrier +- this, Hz
+#define POST_FILTER_CUTOFF 5000.0 // receiver audio lowpass, Hz
+
+// Alpha of the de-emphasis one-pole at `rate`; pre-emphasis is its exact inverse.
+inline float fmEmphasisAlpha(double rate) { return 1.0f - static_cast<float>(std::exp(-1.0 / (FM_EMPHASIS_TAU * rate))); }
+
+// One chain's QAM carrier recovery loop; see CostasLanes. The loop can lock
+// a quarter turn or more away from the transmitter; the phase markers it
+// sends tell by how much.
+struct CarrierLoop {
+    uint32_t phase = 0;
+    float arm_i = 0.0f, arm_q = 0.0f;
+    float freq = 0.0f;
+    float level = 0.0f, quiet = 0.0f, ref_pos = -1.0f; // marker detector, as in CostasLanes
+    float ref_i = 0.0f, ref_q = 0.0f;
+    float rot_c = 1.0f, rot_s = 0.0f; // derotation from the last marker
+    float last_out = 0.0f;
+};
+
+// DSP state for one modulator/channel/demodulator chain. Every stage works on
+// a whole block and leaves its state here so the next block continues from it.
+//
+// With oversampling the modulator, channel and demodulator run at
+// SAMPLE_RATE * oversample between a polyphase interpolator on the audio
+// input and decimators on both outputs; see setOversampling().
+struct ModemState {
+    int oversample = 1;
+    double carrier_freq = 10000.0;
+    double rx_offset = 0.0; // receiver tuning error, Hz
+    Nco tx_carrier{10000.0, SAMPLE_RATE};
+    Nco rx_carrier{10000.0, SAMPLE_RATE};
+    size_t qam_frame_pos = 0; // transmitter position in the marker frame
+    CarrierLoop qam_loop;
+    std::vector<Biquad> am_filter = designButterworthLowpass(AM_SECTIONS, AM_CUTOFF / SAMPLE_RATE);
+    std::vector<float> am_state = std::vector<float>(2 * AM_SECTIONS, 0.0f); // TDF-II s1, s2 per section
+    float fm_pre_last = 0.0f; // last audio sample into the pre-emphasis
+    std::vector<float> fm_history[2] = {std::vector<float>(FM_IF_TAPS - 1, 0.0f),
+                                        std::vector<float>(FM_IF_TAPS - 1, 0.0f)}; // downmixed I/Q the IF filter still needs
+    float fm_last_i = 1.0f, fm_last_q = 0.0f; // last filtered I/Q for the discriminator
+    OnePole deemphasis = makeOnePole(fmEmphasisAlpha(SAMPLE_RATE));
+    float deemphasis_state = 0.0f;
+    NoiseGenerator noise;
+    std::vector<float> echo_buffer = std::vector<float>(ECHO_DELAY, 0.0f);
+    size_t echo_pos = 0;
+    PolyphaseInterpolator upsampler;
+    PolyphaseDecimator mod_decimator, demod_decimator;
+    std::unique_ptr<FirFilter> channel_filter; // on the channel signal, at the modem rate
+    std::unique_ptr<FirFilter> post_filter;    // on the receiver output, at SAMPLE_RATE
+};
+
+// Rate the modem stages run at.
+inline double modemRate(const ModemState& s) { return static_cast<double>(SAMPLE_RATE) * s.oversample; }
+
+void setCarrierFrequency(ModemState& s, float freq);
+// Detune the receiver from the carrier by `offset` Hz, for testing the QAM
+// carrier recovery.
+void setReceiverOffset(ModemState& s, float offset);
+// Run the modem stages at factor (1..OVERSAMPLE_MAX) times SAMPLE_RATE. Setup
+// only: resets the filter states and the resamplers.
+void setOversampling(ModemState& s, int factor);
+// Optional FIR stages, `taps` long, or removed for 0: a bandpass around the
+// carrier after the channel noise and an audio lowpass after the receiver.
+// Long filters add FIR_PARTITION samples of latency. Setup only.
+void setChannelFilter(ModemState& s, int taps);
+void setPostFilter(ModemState& s, int taps);
+void modulateAM(ModemState& s, const float* in, float* out, size_t n);
+void modulateFM(ModemState& s, const float* in, float* out, size_t n);
+void modulateQAM(ModemState& s, const float* in, float* out, size_t n);
+void addNoise(ModemState& s, float* buf, size_t n);
+void filterChannel(ModemState& s, float* buf, size_t n);
+void filterAudio(ModemState& s, float* buf, size_t n);
+void demodAM(ModemState& s, const float* in, float* out, size_t n);
+// demodAM for count <= CHANNEL_LANES chains at once: their envelope filters
+// run side by side in SIMD lanes instead of one recursion per chain.
+void demodAMLanes(ModemState* const* s, const float* const* in, float* const* out, size_t count, size_t n);
+void demodFM(ModemState& s, const float* in, float* out, size_t n);
+void demodQAM(ModemState& s, const float* in, float* out, size_t n);
+// demodQAM for count <= CHANNEL_LANES chains at the same rate: their carrier
+// recovery loops run side by side in SIMD lanes.
+void demodQAMLanes(ModemState* const* s, const float* const* in, float* const* out, size_t count, size_t n);
+void applyEcho(ModemState& s, float* buf, size_t n);
+
+enum class Mode { AM, FM, QAM };
+
+// Per-mode stage selection, resolved at compile time so processBlock<M> has
+// no mode branches in it.
+template <Mode M> struct ModeKernels;
+
+template <> struct ModeKernels<Mode::AM> {
+    static void modulate(ModemState& s, const float* in, float* out, size_t n) { modulateAM(s, in, out, n); }
+    static void demodulate(ModemState& s, const float* in, float* out, size_t n) { demodAM(s, in, out, n); }
+};
+
+template <> struct ModeKernels<Mode::FM> {
+    static void modulate(ModemState& s, const float* in, float* out, size_t n) { modulateFM(s, in, out, n); }
+    static void demodulate(ModemState& s, const float* in, float* out, size_t n) { demodFM(s, in, out, n); }
+};
+
+template <> struct ModeKernels<Mode::QAM> {
+    static void modulate(ModemState& s, const float* in, float* out, size_t n) { modulateQAM(s, in, out, n); }
+    static void demodulate(ModemState& s, const float* in, float* out, size_t n) { demodQAM(s, in, out, n); }
+};
+
+// Modulate, add channel noise, filter and demodulate one block. `mod`
+// receives the channel signal and `demod` the receiver output, both at
+// SAMPLE_RATE.
+template <Mode M>
+void processBlock(ModemState& s, const float* in, float* mod, float* demod, size_t n) {
+    if (s.oversample == 1) {
+        ModeKernels<M>::modulate(s, in, mod, n);
+        addNoise(s, mod, n);
+        filterChannel(s, mod, n);
+        ModeKernels<M>::demodulate(s, mod, demod, n);
+        filterAudio(s, demod, n);
+        return;
+    }
+    float in_high[KERNEL_BLOCK], mod_high[KERNEL_BLOCK], demod_high[KERNEL_BLOCK];
+    size_t step = KERNEL_BLOCK / s.oversample;
+    for (size_t i = 0; i < n; i += step) {
+        size_t m = std::min(step, n - i);
+        size_t high = m * s.oversample;
+        s.upsampler.process(in + i, in_high, m);
+        ModeKernels<M>::modulate(s, in_high, mod_high, high);
+        addNoise(s, mod_high, high);
+        filterChannel(s, mod_high, high);
+        ModeKernels<M>::demodulate(s, mod_high, demod_high, high);
+        s.mod_decimator.process(mod_high, mod + i, m);
+        s.demod_decimator.process(demod_high, demod + i, m);
+    }
+    filterAudio(s, demod, n);
+}
+
+// processBlock for count <= CHANNEL_LANES chains fed the same input, with
+// AM and QAM demodulated together through demodAMLanes/demodQAMLanes. The
+// chains must not be oversampled.
+void processBlockLanes(Mode mode, ModemState* const* s, const float* in, float* const* mod, float* const* demod,
+                       size_t count, size_t n);
+
+// Picks the specialization once per block.
+inline void processBlock(Mode mode, ModemState& s, const float* in, float* mod, float* demod, size_t n) {
+    switch (mode) {
+    case Mode::FM: processBlock<Mode::FM>(s, in, mod, demod, n); break;
+    case Mode::QAM: processBlock<Mode::QAM>(s, in, mod, demod, n); break;
+    default: processBlock<Mode::AM>(s, in, mod, demod, n); break;
+    }
+}
+
+#endif // MODEM_H
@@ -0,0 +1,60 @@
+// Checks the QAM receiver recovers the transmitted I bits whatever phase its
+// carrier loop locks at. Each case runs AM for a while, then switches the
+// chain to QAM the way the GUI does, and compares the demodulated output with
+// the sign of the audio once the first phase marker has passed. Returns
+// nonzero if any case falls short.
+#include <cmath>
+#include <cstdio>
+#include <vector>
+#include "modem.h"
+
+#define TEST_BLOCK 256
+#define TEST_SETTLE SAMPLE_RATE // pull-in from 150 Hz at noise 0.3 takes over half a second
+#define TEST_LENGTH (2 * SAMPLE_RATE)
+#define TEST_MIN_AGREEMENT 0.95 // markers hold the output for about 1.5% of samples
+
+static double qamAgreement(size_t am_samples, float rx_offset, float noise, int oversample) {
+    ModemState s;
+    setOversampling(s, oversample);
+    s.noise.seed(am_samples + 1);
+    s.noise.setLevel(noise);
+    setReceiverOffset(s, rx_offset);
+    size_t total = am_samples + TEST_LENGTH;
+    std::vector<float> audio(total), mod(total), demod(total);
+    for (size_t i = 0; i < total; i++)
+        audio[i] = 0.6f * sinf(2 * M_PI * 440.0f * i / SAMPLE_RATE) + 0.3f * sinf(2 * M_PI * 97.0f * i / SAMPLE_RATE);
+    for (size_t i = 0; i < total;) {
+        Mode mode = i < am_samples ? Mode::AM : Mode::QAM;
+        size_t m = std::min<size_t>(TEST_BLOCK, (mode == Mode::AM ? am_samples : total) - i);
+        processBlock(mode, s, audio.data() + i, mod.data() + i, demod.data() + i, m);
+        i += m;
+    }
+    // The arm filters and, when oversampling, the resamplers delay the output.
+    double best = 0.0;
+    for (size_t delay = 0; delay <= 2 * OVERSAMPLE_TAPS; delay++) {
+        size_t agree = 0, count = 0;
+        for (size_t i = am_samples + TEST_SETTLE; i < total; i++, count++)
+            agree += (demod[i] > 0) == (audio[i - delay] > 0);
+        best = std::max(best, static_cast<double>(agree) / count);
+    }
+    return best;
+}
+
+int main() {
+    printf("DSP kernels: %s\n", dspKernels().name);
+    int failures = 0;
+    for (int oversample : {1, 4}) {
+        for (size_t am_samples : {1, 3, 5, 100, 257, 1000, 4097, 12345}) {
+            for (float rx_offset : {0.0f, 75.0f, -150.0f}) {
+                for (float noise : {0.0f, 0.1f, 0.3f}) {
+                    double agreement = qamAgreement(am_samples, rx_offset, noise, oversample);
+                    bool ok = agreement >= TEST_MIN_AGREEMENT;
+                    failures += !ok;
+                    printf("%s %dx, AM %5zu samples, rx offset %6.1f Hz, noise %.1f: %.4f\n", ok ? "ok  " : "FAIL",
+                           oversample, am_samples, rx_offset, noise, agreement);
+                }
+            }
+        }
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,180 @@
+// Throughput of the DSP hot paths at SAMPLE_RATE, by block size. The
+// rt_channels counter is how many real-time streams one core sustains;
+// BM_OversampledChain covers the modem running at higher rates. Set
+// MODEM_SIMD to compare kernel sets.
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <vector>
+#include "modem.h"
+#include "spectrum.h"
+
+typedef void (*StageFn)(ModemState&, const float*, float*, size_t);
+
+static std::vector<float> testAudio(size_t n) {
+    std::vector<float> audio(n);
+    for (size_t i = 0; i < n; i++) audio[i] = 0.5f * sinf(2 * M_PI * 440.0f * i / SAMPLE_RATE);
+    return audio;
+}
+
+static void setCounters(benchmark::State& state) {
+    double samples = static_cast<double>(state.iterations()) * state.range(0);
+    state.SetItemsProcessed(static_cast<int64_t>(samples));
+    state.counters["sec/sample"] = benchmark::Counter(samples, benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+    state.counters["rt_channels"] = benchmark::Counter(samples / SAMPLE_RATE, benchmark::Counter::kIsRate);
+}
+
+static void BM_Modulate(benchmark::State& state, StageFn modulate) {
+    size_t n = state.range(0);
+    ModemState s;
+    std::vector<float> in = testAudio(n), out(n);
+    for (auto _ : state) {
+        modulate(s, in.data(), out.data(), n);
+        benchmark::DoNotOptimize(out.data());
+    }
+    setCounters(state);
+}
+
+static void BM_Demodulate(benchmark::State& state, StageFn modulate, StageFn demodulate) {
+    size_t n = state.range(0);
+    ModemState s;
+    std::vector<float> audio = testAudio(n), in(n), out(n);
+    modulate(s, audio.data(), in.data(), n);
+    for (auto _ : state) {
+        demodulate(s, in.data(), out.data(), n);
+        benchmark::DoNotOptimize(out.data());
+    }
+    setCounters(state);
+}
+
+// Receivers for several chains at once; rt_channels counts every chain.
+typedef void (*LanesFn)(ModemState* const*, const float* const*, float* const*, size_t, size_t);
+
+static void BM_DemodulateLanes(benchmark::State& state, StageFn modulate, LanesFn demodulate) {
+    size_t n = state.range(0), count = state.range(1);
+    std::vector<ModemState> chains(count);
+    std::vector<float> audio = testAudio(n), in(n);
+    std::vector<std::vector<float>> out(count, std::vector<float>(n));
+    std::vector<ModemState*> states;
+    std::vector<const float*> ins;
+    std::vector<float*> outs;
+    modulate(chains[0], audio.data(), in.data(), n);
+    for (size_t c = 0; c < count; c++) {
+        states.push_back(&chains[c]);
+        ins.push_back(in.data());
+        outs.push_back(out[c].data());
+    }
+    for (auto _ : state) {
+        demodulate(states.data(), ins.data(), outs.data(), count, n);
+        benchmark::DoNotOptimize(outs.data());
+    }
+    double samples = static_cast<double>(state.iterations()) * n * count;
+    state.SetItemsProcessed(static_cast<int64_t>(samples));
+    state.counters["rt_channels"] = benchmark::Counter(samples / SAMPLE_RATE, benchmark::Counter::kIsRate);
+}
+
+static void BM_Chain(benchmark::State& state, Mode mode) {
+    size_t n = state.range(0);
+    ModemState s;
+    std::vector<float> in = testAudio(n), mod(n), demod(n);
+    for (auto _ : state) {
+        processBlock(mode, s, in.data(), mod.data(), demod.data(), n);
+        benchmark::DoNotOptimize(demod.data());
+    }
+    setCounters(state);
+}
+
+// The chain with the modem stages oversampled; block size and rt_channels are
+// at the audio rate.
+static void BM_OversampledChain(benchmark::State& state, Mode mode) {
+    size_t n = state.range(0);
+    ModemState s;
+    setOversampling(s, state.range(1));
+    std::vector<float> in = testAudio(n), mod(n), demod(n);
+    for (auto _ : state) {
+        processBlock(mode, s, in.data(), mod.data(), demod.data(), n);
+        benchmark::DoNotOptimize(demod.data());
+    }
+    double samples = static_cast<double>(state.iterations()) * n;
+    state.SetItemsProcessed(static_cast<int64_t>(samples));
+    state.counters["rt_channels"] = benchmark::Counter(samples / SAMPLE_RATE, benchmark::Counter::kIsRate);
+}
+
+// FirFilter at a given kernel length; short kernels run direct, long ones
+// through partitioned FFT convolution.
+static void BM_FirFilter(benchmark::State& state) {
+    size_t n = state.range(0);
+    FirFilter filter(designLowpassFir(state.range(1), 5000.0 / SAMPLE_RATE));
+    std::vector<float> buf = testAudio(n);
+    for (auto _ : state) {
+        filter.process(buf.data(), buf.data(), n);
+        benchmark::DoNotOptimize(buf.data());
+    }
+    double samples = static_cast<double>(state.iterations()) * n;
+    state.SetItemsProcessed(static_cast<int64_t>(samples));
+    state.counters["rt_channels"] = benchmark::Counter(samples / SAMPLE_RATE, benchmark::Counter::kIsRate);
+}
+
+static void BM_Noise(benchmark::State& state) {
+    size_t n = state.range(0);
+    NoiseGenerator noise(1, 0.1f);
+    std::vector<float> buf(n, 0.0f);
+    for (auto _ : state) {
+        noise.addTo(buf.data(), n);
+        benchmark::DoNotOptimize(buf.data());
+    }
+    setCounters(state);
+}
+
+static void BM_Echo(benchmark::State& state) {
+    size_t n = state.range(0);
+    ModemState s;
+    std::vector<float> buf = testAudio(n);
+    for (auto _ : state) {
+        applyEcho(s, buf.data(), n);
+        benchmark::DoNotOptimize(buf.data());
+    }
+    setCounters(state);
+}
+
+// Streaming STFT at its default 75% overlap: one block of fft_size samples
+// runs four windowed frames.
+static void BM_Spectrum(benchmark::State& state) {
+    size_t n = state.range(0);
+    SpectrumAnalyzer analyzer(SAMPLE_RATE, n);
+    std::vector<float> audio = testAudio(n);
+    for (auto _ : state) {
+        analyzer.push(audio.data(), n);
+        analyzer.process();
+        benchmark::DoNotOptimize(analyzer.magnitude().data());
+    }
+    setCounters(state);
+}
+
+static void blockSizes(benchmark::internal::Benchmark* b) {
+    b->ArgName("block")->RangeMultiplier(4)->Range(64, 16384);
+}
+
+BENCHMARK_CAPTURE(BM_Modulate, am, modulateAM)->Apply(blockSizes);
+BENCHMARK_CAPTURE(BM_Modulate, fm, modulateFM)->Apply(blockSizes);
+BENCHMARK_CAPTURE(BM_Modulate, qam, modulateQAM)->Apply(blockSizes);
+BENCHMARK_CAPTURE(BM_Demodulate, am, modulateAM, demodAM)->Apply(blockSizes);
+BENCHMARK_CAPTURE(BM_Demodulate, fm, modulateFM, demodFM)->Apply(blockSizes);
+BENCHMARK_CAPTURE(BM_Demodulate, qam, modulateQAM, demodQAM)->Apply(blockSizes);
+BENCHMARK_CAPTURE(BM_DemodulateLanes, am, modulateAM, demodAMLanes)
+    ->ArgNames({"block", "chains"})
+    ->ArgsProduct({{256, 4096}, {1, 4, 8, 16}});
+BENCHMARK_CAPTURE(BM_DemodulateLanes, qam, modulateQAM, demodQAMLanes)
+    ->ArgNames({"block", "chains"})
+    ->ArgsProduct({{256, 4096}, {1, 4, 8, 16}});
+BENCHMARK_CAPTURE(BM_Chain, am, Mode::AM)->Apply(blockSizes);
+BENCHMARK_CAPTURE(BM_Chain, fm, Mode::FM)->Apply(blockSizes);
+BENCHMARK_CAPTURE(BM_Chain, qam, Mode::QAM)->Apply(blockSizes);
+BENCHMARK_CAPTURE(BM_OversampledChain, am, Mode::AM)->ArgNames({"block", "factor"})->ArgsProduct({{256, 4096}, {1, 2, 4, 8}});
+BENCHMARK_CAPTURE(BM_OversampledChain, fm, Mode::FM)->ArgNames({"block", "factor"})->ArgsProduct({{256, 4096}, {1, 2, 4, 8}});
+BENCHMARK_CAPTURE(BM_OversampledChain, qam, Mode::QAM)->ArgNames({"block", "factor"})->ArgsProduct({{256, 4096}, {1, 2, 4, 8}});
+BENCHMARK(BM_FirFilter)->ArgNames({"block", "taps"})->ArgsProduct({{64, 256, 4096}, {31, 127, 255, 1023, 4095}});
+BENCHMARK(BM_Noise)->Apply(blockSizes);
+BENCHMARK(BM_Echo)->Apply(blockSizes);
+BENCHMARK(BM_Spectrum)->ArgName("fft")->RangeMultiplier(4)->Range(SPECTRUM_MIN_FFT, SPECTRUM_MAX_FFT);
+
+BENCHMARK_MAIN();
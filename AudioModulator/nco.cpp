@@ -0,0 +1,26 @@
+#include "nco.h"
+#include "dsp_kernels.h"
+#include <cmath>
+
+namespace {
+struct SineTable {
+    float values[NCO_TABLE_SIZE + 1];
+    SineTable() {
+        for (int i = 0; i <= NCO_TABLE_SIZE; i++)
+            values[i] = static_cast<float>(sin(2 * M_PI * i / NCO_TABLE_SIZE));
+    }
+};
+}
+
+const float* ncoSineTable() {
+    static const SineTable table;
+    return table.values;
+}
+
+void Nco::fill(float* out, size_t n) {
+    dspKernels().oscillator(&acc, increment, table, out, nullptr, n);
+}
+
+void Nco::fill(float* sin_out, float* cos_out, size_t n) {
+    dspKernels().oscillator(&acc, increment, table, sin_out, cos_out, n);
+}
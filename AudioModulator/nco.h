@@ -0,0 +1,72 @@
+#ifndef NCO_H
+#define NCO_H
+
+#include <cstddef>
+#include <cstdint>
+
+#define NCO_TABLE_BITS 12
+#define NCO_TABLE_SIZE (1 << NCO_TABLE_BITS)
+#define NCO_FRAC_BITS (32 - NCO_TABLE_BITS)
+
+// Sine over one period, NCO_TABLE_SIZE + 1 entries (the last repeats the first
+// so interpolation never has to wrap).
+const float* ncoSineTable();
+
+// Numerically controlled oscillator. The phase is a 32-bit fixed-point
+// fraction of a cycle, so it wraps exactly and never loses precision however
+// long the carrier runs. Output comes from an interpolated lookup table.
+class Nco {
+public:
+    Nco() : table(ncoSineTable()) {}
+    Nco(double freq, double sample_rate) : table(ncoSineTable()) { setFrequency(freq, sample_rate); }
+
+    void setFrequency(double freq, double sample_rate) { increment = cyclesToPhase(freq / sample_rate); }
+    uint32_t phaseIncrement() const { return increment; }
+    uint32_t phase() const { return acc; }
+    const float* sineTable() const { return table; }
+    void setPhase(uint32_t p) { acc = p; }
+
+    // Phase units for a fraction of a cycle; negative values wrap backwards.
+    static uint32_t cyclesToPhase(double cycles) {
+        double frac = cycles - static_cast<int64_t>(cycles);
+        if (frac < 0) frac += 1.0;
+        return static_cast<uint32_t>(static_cast<uint64_t>(frac * 4294967296.0));
+    }
+
+    float sine(uint32_t p) const {
+        uint32_t idx = p >> NCO_FRAC_BITS;
+        float frac = (p & ((1u << NCO_FRAC_BITS) - 1)) * (1.0f / (1u << NCO_FRAC_BITS));
+        return table[idx] + frac * (table[idx + 1] - table[idx]);
+    }
+    float cosine(uint32_t p) const { return sine(p + 0x40000000u); }
+
+    // Advance one sample and return the new sine value.
+    float next() {
+        acc += increment;
+        return sine(acc);
+    }
+
+    // Advance one sample and return both quadrature components.
+    void next(float& sin_out, float& cos_out) {
+        acc += increment;
+        sin_out = sine(acc);
+        cos_out = cosine(acc);
+    }
+
+    // Advance by the carrier increment plus `offset` (frequency modulation).
+    float nextOffset(int32_t offset) {
+        acc += increment + static_cast<uint32_t>(offset);
+        return sine(acc);
+    }
+
+    // Block versions of next(), run through the SIMD oscillator kernel.
+    void fill(float* out, size_t n);
+    void fill(float* sin_out, float* cos_out, size_t n);
+
+private:
+    const float* table;
+    uint32_t acc = 0;
+    uint32_t increment = 0;
+};
+
+#endif // NCO_H
@@ -0,0 +1,39 @@
+#include "noise.h"
+#include "nco.h"
+#include <algorithm>
+
+NoiseGenerator::NoiseGenerator(uint64_t seed, float level) : level(level) {
+    this->seed(seed);
+}
+
+void NoiseGenerator::seed(uint64_t seed) {
+    // splitmix64 spreads one seed over every lane's state.
+    for (int i = 0; i < 4 * NOISE_LANES; i += 2) {
+        uint64_t z = (seed += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        z ^= z >> 31;
+        state[i] = static_cast<uint32_t>(z);
+        state[i + 1] = static_cast<uint32_t>(z >> 32);
+    }
+    pending_pos = NOISE_CHUNK;
+}
+
+void NoiseGenerator::addTo(float* buf, size_t n) {
+    const DspKernels& k = dspKernels();
+    const float* table = ncoSineTable();
+    while (pending_pos < NOISE_CHUNK && n > 0) {
+        *buf++ += level * pending[pending_pos++];
+        n--;
+    }
+    size_t chunks = n / NOISE_CHUNK;
+    k.addGaussian(state, table, level, buf, chunks);
+    buf += chunks * NOISE_CHUNK;
+    n -= chunks * NOISE_CHUNK;
+    if (n > 0) {
+        std::fill(pending, pending + NOISE_CHUNK, 0.0f);
+        k.addGaussian(state, table, 1.0f, pending, 1);
+        for (pending_pos = 0; pending_pos < n; pending_pos++)
+            buf[pending_pos] += level * pending[pending_pos];
+    }
+}
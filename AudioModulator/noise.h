@@ -0,0 +1,32 @@
+#ifndef NOISE_H
+#define NOISE_H
+
+#include <cstddef>
+#include <cstdint>
+#include "dsp_kernels.h"
+
+#define NOISE_CHUNK (2 * NOISE_LANES)
+
+// Block Gaussian noise for the channel stage: Box-Muller over 16 interleaved
+// xoshiro128+ generators, filled a chunk at a time by the SIMD kernels. The
+// output only depends on the seed, not on how the caller splits its blocks,
+// and the level is a plain scale so it can change between blocks for free.
+class NoiseGenerator {
+public:
+    explicit NoiseGenerator(uint64_t seed = 0, float level = 0.1f);
+
+    void seed(uint64_t seed);
+    void setLevel(float level) { this->level = level; }
+    float getLevel() const { return level; }
+
+    // buf += level * N(0, 1)
+    void addTo(float* buf, size_t n);
+
+private:
+    uint32_t state[4 * NOISE_LANES];
+    float pending[NOISE_CHUNK]; // unit-variance samples left over from the last call
+    size_t pending_pos = NOISE_CHUNK;
+    float level;
+};
+
+#endif // NOISE_H
@@ -25,6 +25,17 @@
 
 #include "qcustomplot.h"
 
+#include <QtCore/QRunnable>
+#include <QtCore/QSemaphore>
+#include <QtCore/QThreadPool>
+#include <functional>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#endif
+
 
 /* including file 'src/vector2d.cpp'       */
 /* modified 2022-11-06T12:45:56, size 7973 */
@@ -16688,6 +16699,157 @@ void QCPColorGradient::setPeriodic(bool enabled)
   mPeriodic = enabled;
 }
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define QCP_COLORIZE_X86
+
+namespace {
+
+/*! \internal
+  
+  Premultiplies \a rgb with the cell alpha \a alpha exactly like the scalar path of \ref
+  QCPColorGradient::colorize.
+*/
+inline QRgb qcpPremultiplied(QRgb rgb, unsigned char alpha)
+{
+  const float alphaF = alpha/255.0f;
+  return qRgba(int(qRed(rgb)*alphaF), int(qGreen(rgb)*alphaF), int(qBlue(rgb)*alphaF), int(qAlpha(rgb)*alphaF));
+}
+
+/*! \internal
+  
+  SSE2 part of \ref QCPColorGradient::colorize for non-periodic gradients: normalizes, clamps and
+  truncates two cells per instruction, four cells per iteration. The result is identical to the
+  scalar loop, because the value is clamped to [0, levelCount-1] before truncation, which is what
+  qBound does after truncation. Cells that are NaN get \a nanColor if \a checkNan is set. Returns
+  the number of cells written, the caller colorizes the rest.
+*/
+__attribute__((target("sse2")))
+int qcpColorizeSse2(const double *data, const unsigned char *alpha, int dataIndexFactor, int n, double lower, double factor,
+                    bool logarithmic, const QRgb *colors, int levelCount, QRgb nanColor, bool checkNan, QRgb *scanLine)
+{
+  const __m128d lowerV = _mm_set1_pd(lower);
+  const __m128d factorV = _mm_set1_pd(factor);
+  const __m128d zero = _mm_setzero_pd();
+  const __m128d maxIndex = _mm_set1_pd(levelCount-1);
+  int i = 0;
+  for (; i+4 <= n; i += 4)
+  {
+    int index[4];
+    int nanBits = 0;
+    for (int half=0; half<2; ++half)
+    {
+      const double *cell = data + (i+2*half)*dataIndexFactor;
+      const __m128d value = dataIndexFactor == 1 ? _mm_loadu_pd(cell) : _mm_set_pd(cell[dataIndexFactor], cell[0]);
+      __m128d position;
+      if (logarithmic)
+      {
+        double lanes[2];
+        _mm_storeu_pd(lanes, value);
+        lanes[0] = qLn(lanes[0]/lower);
+        lanes[1] = qLn(lanes[1]/lower);
+        position = _mm_mul_pd(_mm_loadu_pd(lanes), factorV);
+      } else
+        position = _mm_mul_pd(_mm_sub_pd(value, lowerV), factorV);
+      position = _mm_min_pd(_mm_max_pd(position, zero), maxIndex); // max_pd returns zero for NaN lanes
+      _mm_storel_epi64(reinterpret_cast<__m128i*>(index+2*half), _mm_cvttpd_epi32(position));
+      nanBits |= _mm_movemask_pd(_mm_cmpunord_pd(value, value)) << (2*half);
+    }
+    for (int k=0; k<4; ++k)
+    {
+      if (checkNan && (nanBits & (1 << k)))
+        scanLine[i+k] = nanColor;
+      else if (alpha)
+        scanLine[i+k] = qcpPremultiplied(colors[index[k]], alpha[(i+k)*dataIndexFactor]);
+      else
+        scanLine[i+k] = colors[index[k]];
+    }
+  }
+  return i;
+}
+
+/*! \internal
+  
+  AVX2 version of \ref qcpColorizeSse2: eight cells per iteration, with the color lookup done by a
+  gather and the alpha premultiplication in single precision like the scalar path.
+*/
+__attribute__((target("avx2")))
+int qcpColorizeAvx2(const double *data, const unsigned char *alpha, int dataIndexFactor, int n, double lower, double factor,
+                    bool logarithmic, const QRgb *colors, int levelCount, QRgb nanColor, bool checkNan, QRgb *scanLine)
+{
+  const __m256d lowerV = _mm256_set1_pd(lower);
+  const __m256d factorV = _mm256_set1_pd(factor);
+  const __m256d zero = _mm256_setzero_pd();
+  const __m256d maxIndex = _mm256_set1_pd(levelCount-1);
+  const __m256 alphaScale = _mm256_set1_ps(255.0f);
+  const __m256i byteMask = _mm256_set1_epi32(0xFF);
+  const int s = dataIndexFactor;
+  int i = 0;
+  for (; i+8 <= n; i += 8)
+  {
+    __m128i index[2];
+    int nanBits = 0;
+    for (int half=0; half<2; ++half)
+    {
+      const double *cell = data + (i+4*half)*s;
+      const __m256d value = s == 1 ? _mm256_loadu_pd(cell) : _mm256_set_pd(cell[3*s], cell[2*s], cell[s], cell[0]);
+      __m256d position;
+      if (logarithmic)
+      {
+        double lanes[4];
+        _mm256_storeu_pd(lanes, value);
+        for (int k=0; k<4; ++k)
+          lanes[k] = qLn(lanes[k]/lower);
+        position = _mm256_mul_pd(_mm256_loadu_pd(lanes), factorV);
+      } else
+        position = _mm256_mul_pd(_mm256_sub_pd(value, lowerV), factorV);
+      position = _mm256_min_pd(_mm256_max_pd(position, zero), maxIndex); // max_pd returns zero for NaN lanes
+      index[half] = _mm256_cvttpd_epi32(position);
+      nanBits |= _mm256_movemask_pd(_mm256_cmp_pd(value, value, _CMP_UNORD_Q)) << (4*half);
+    }
+    __m256i rgb = _mm256_i32gather_epi32(reinterpret_cast<const int*>(colors), _mm256_inserti128_si256(_mm256_castsi128_si256(index[0]), index[1], 1), 4);
+    if (alpha)
+    {
+      const unsigned char *a = alpha + i*s;
+      const __m256i alphaBytes = s == 1 ? _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(a)))
+                                        : _mm256_setr_epi32(a[0], a[s], a[2*s], a[3*s], a[4*s], a[5*s], a[6*s], a[7*s]);
+      const __m256 alphaF = _mm256_div_ps(_mm256_cvtepi32_ps(alphaBytes), alphaScale);
+      __m256i premultiplied = _mm256_setzero_si256();
+      for (int shift=0; shift<32; shift += 8)
+      {
+        const __m128i count = _mm_cvtsi32_si128(shift);
+        const __m256 channel = _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srl_epi32(rgb, count), byteMask));
+        premultiplied = _mm256_or_si256(premultiplied, _mm256_sll_epi32(_mm256_cvttps_epi32(_mm256_mul_ps(channel, alphaF)), count));
+      }
+      rgb = premultiplied;
+    }
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(scanLine+i), rgb);
+    if (checkNan && nanBits)
+    {
+      for (int k=0; k<8; ++k)
+        if (nanBits & (1 << k))
+          scanLine[i+k] = nanColor;
+    }
+  }
+  return i;
+}
+
+/*! \internal
+  
+  Colorizes as many leading cells as the widest available instruction set handles in whole
+  vectors and returns their number. See \ref QCPColorGradient::colorize.
+*/
+int qcpColorizeSimd(const double *data, const unsigned char *alpha, int dataIndexFactor, int n, double lower, double factor,
+                    bool logarithmic, const QRgb *colors, int levelCount, QRgb nanColor, bool checkNan, QRgb *scanLine)
+{
+  static const bool hasAvx2 = (__builtin_cpu_init(), __builtin_cpu_supports("avx2"));
+  if (hasAvx2)
+    return qcpColorizeAvx2(data, alpha, dataIndexFactor, n, lower, factor, logarithmic, colors, levelCount, nanColor, checkNan, scanLine);
+  return qcpColorizeSse2(data, alpha, dataIndexFactor, n, lower, factor, logarithmic, colors, levelCount, nanColor, checkNan, scanLine);
+}
+
+} // anonymous namespace
+#endif
+
 /*! \overload
   
   This method is used to quickly convert a \a data array to colors. The colors will be output in
@@ -16724,7 +16886,12 @@ void QCPColorGradient::colorize(const double *data, const QCPRange &range, QRgb
   
   const bool skipNanCheck = mNanHandling == nhNone;
   const double posToIndexFactor = !logarithmic ? (mLevelCount-1)/range.size() : (mLevelCount-1)/qLn(range.upper/range.lower);
-  for (int i=0; i<n; ++i)
+  int i = 0;
+#ifdef QCP_COLORIZE_X86
+  if (!mPeriodic) // vector path for the bulk of the cells, the loop below does the tail
+    i = qcpColorizeSimd(data, nullptr, dataIndexFactor, n, range.lower, posToIndexFactor, logarithmic, mColorBuffer.constData(), mLevelCount, nanRgb(), !skipNanCheck, scanLine);
+#endif
+  for (; i<n; ++i)
   {
     const double value = data[dataIndexFactor*i];
     if (skipNanCheck || !std::isnan(value))
@@ -16785,7 +16952,12 @@ void QCPColorGradient::colorize(const double *data, const unsigned char *alpha,
   
   const bool skipNanCheck = mNanHandling == nhNone;
   const double posToIndexFactor = !logarithmic ? (mLevelCount-1)/range.size() : (mLevelCount-1)/qLn(range.upper/range.lower);
-  for (int i=0; i<n; ++i)
+  int i = 0;
+#ifdef QCP_COLORIZE_X86
+  if (!mPeriodic) // vector path for the bulk of the cells, the loop below does the tail
+    i = qcpColorizeSimd(data, alpha, dataIndexFactor, n, range.lower, posToIndexFactor, logarithmic, mColorBuffer.constData(), mLevelCount, nanRgb(), !skipNanCheck, scanLine);
+#endif
+  for (; i<n; ++i)
   {
     const double value = data[dataIndexFactor*i];
     if (skipNanCheck || !std::isnan(value))
@@ -17020,6 +17192,24 @@ bool QCPColorGradient::stopsUseAlpha() const
   return false;
 }
 
+/*! \internal
+  
+  Returns the color that \ref colorize assigns to NaN cells under the current \ref setNanHandling.
+  Requires an up-to-date color buffer.
+*/
+QRgb QCPColorGradient::nanRgb() const
+{
+  switch(mNanHandling)
+  {
+  case nhLowestColor: return mColorBuffer.first();
+  case nhHighestColor: return mColorBuffer.last();
+  case nhTransparent: return qRgba(0, 0, 0, 0);
+  case nhNanColor: return mNanColor.rgba();
+  case nhNone: break;
+  }
+  return qRgba(0, 0, 0, 0);
+}
+
 /*! \internal
   
   Updates the internal color buffer which will be used by \ref colorize and \ref color, to quickly
@@ -20811,6 +21001,178 @@ QCPGraphData::QCPGraphData(double key, double value) :
 }
 
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPGraphDataPyramid
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPGraphDataPyramid
+  \brief Multi-resolution min/max envelope of a QCPGraphDataContainer
+  
+  Level 0 holds the value bounds of every full block of 16 consecutive data points. Each further
+  level merges pairs of blocks from the level below. \ref valueBounds then finds the minimum and
+  maximum value of any index range from O(log n) blocks plus at most 15 raw points at either end.
+  The levels take about an eighth of the memory of the data itself.
+  
+  \ref update brings the levels up to date with a container. Points appended since the last call
+  only extend the levels. Anything else, i.e. a different container, fewer points or changed keys
+  at the ends of the previously covered range, rebuilds them. Changes that keep the keys, such as
+  overwriting values in place, can't be detected this way, so call \ref clear after those.
+  
+  QCPGraph uses this class to draw very large data sets, see \ref QCPGraph::setDecimationPyramid.
+*/
+
+static const int qcpPyramidBlockSize = 16; // data points per block on level 0
+
+/*!
+  Constructs an empty pyramid. It is built by the first call to \ref update.
+*/
+QCPGraphDataPyramid::QCPGraphDataPyramid() :
+  mData(nullptr),
+  mCoveredCount(0),
+  mFirstKey(0),
+  mLastKey(0)
+{
+}
+
+/*!
+  Brings the levels up to date with \a data, which must be sorted by key (as any
+  QCPGraphDataContainer is). Appended points only extend the existing levels, other changes rebuild
+  them.
+*/
+void QCPGraphDataPyramid::update(const QCPGraphDataContainer *data)
+{
+  const int count = data ? data->size() : 0;
+  if (data != mData || count < mCoveredCount ||
+      (mCoveredCount > 0 && (data->constBegin()->key != mFirstKey || (data->constBegin()+(mCoveredCount-1))->key != mLastKey)))
+  {
+    clear();
+    mData = data;
+  }
+  if (count == mCoveredCount)
+    return;
+  
+  // fold the newly completed blocks into level 0, then pairs of new blocks into the levels above:
+  if (mLevels.isEmpty())
+    mLevels.append(QVector<QCPRange>());
+  const QCPGraphDataContainer::const_iterator dataBegin = data->constBegin();
+  for (int block=mLevels.first().size(); block<count/qcpPyramidBlockSize; ++block)
+  {
+    QCPRange bounds((std::numeric_limits<double>::max)(), -(std::numeric_limits<double>::max)());
+    const QCPGraphDataContainer::const_iterator blockEnd = dataBegin+(block+1)*qcpPyramidBlockSize;
+    for (QCPGraphDataContainer::const_iterator it=dataBegin+block*qcpPyramidBlockSize; it!=blockEnd; ++it)
+    {
+      if (it->value < bounds.lower)
+        bounds.lower = it->value;
+      if (it->value > bounds.upper)
+        bounds.upper = it->value;
+    }
+    mLevels.first().append(bounds);
+  }
+  for (int level=1; mLevels.at(level-1).size() >= 2; ++level)
+  {
+    if (mLevels.size() == level)
+      mLevels.append(QVector<QCPRange>());
+    const QVector<QCPRange> &below = mLevels.at(level-1);
+    QVector<QCPRange> &current = mLevels[level];
+    for (int block=current.size(); block<below.size()/2; ++block)
+      current.append(QCPRange(qMin(below.at(2*block).lower, below.at(2*block+1).lower), qMax(below.at(2*block).upper, below.at(2*block+1).upper)));
+  }
+  
+  mCoveredCount = count;
+  mFirstKey = dataBegin->key;
+  mLastKey = (dataBegin+(count-1))->key;
+}
+
+/*!
+  Discards all levels. The next \ref update rebuilds them from scratch.
+*/
+void QCPGraphDataPyramid::clear()
+{
+  mData = nullptr;
+  mCoveredCount = 0;
+  mLevels.clear();
+}
+
+/*!
+  Returns the smallest and largest value of the data points with indices \a beginIndex up to but
+  not including \a endIndex. NaN values are ignored; if there are no other values, the returned
+  range has its lower bound above its upper bound.
+  
+  The indices refer to the container passed to the last \ref update, which must not have changed
+  since.
+*/
+QCPRange QCPGraphDataPyramid::valueBounds(int beginIndex, int endIndex) const
+{
+  QCPRange bounds((std::numeric_limits<double>::max)(), -(std::numeric_limits<double>::max)());
+  if (!mData || beginIndex >= endIndex)
+    return bounds;
+  const QCPGraphDataContainer::const_iterator dataBegin = mData->constBegin();
+  // raw points before the first and after the last block boundary:
+  while (beginIndex < endIndex && beginIndex % qcpPyramidBlockSize != 0)
+  {
+    const double value = (dataBegin+beginIndex)->value;
+    if (value < bounds.lower)
+      bounds.lower = value;
+    if (value > bounds.upper)
+      bounds.upper = value;
+    ++beginIndex;
+  }
+  while (endIndex > beginIndex && endIndex % qcpPyramidBlockSize != 0)
+  {
+    --endIndex;
+    const double value = (dataBegin+endIndex)->value;
+    if (value < bounds.lower)
+      bounds.lower = value;
+    if (value > bounds.upper)
+      bounds.upper = value;
+  }
+  // whole blocks, climbing a level whenever both ends are aligned to the next block size:
+  int lower = beginIndex/qcpPyramidBlockSize;
+  int upper = endIndex/qcpPyramidBlockSize;
+  for (int level=0; lower<upper; ++level)
+  {
+    const QVector<QCPRange> &blocks = mLevels.at(level);
+    if (lower % 2 != 0)
+    {
+      bounds.lower = qMin(bounds.lower, blocks.at(lower).lower);
+      bounds.upper = qMax(bounds.upper, blocks.at(lower).upper);
+      ++lower;
+    }
+    if (upper % 2 != 0)
+    {
+      --upper;
+      bounds.lower = qMin(bounds.lower, blocks.at(upper).lower);
+      bounds.upper = qMax(bounds.upper, blocks.at(upper).upper);
+    }
+    lower /= 2;
+    upper /= 2;
+  }
+  return bounds;
+}
+
+
+/*! \internal
+  
+  Minimum number of data points per chunk for the parallel adaptive sampling of QCPGraph (see \ref
+  QCPGraph::setParallelSampling). Smaller chunks aren't worth the thread pool hand-off.
+*/
+static const int qcpMinSamplingChunkSize = 1 << 17;
+
+/*! \internal
+  
+  Thread pool task that samples one chunk of a QCPGraph and releases \a finished when done.
+*/
+class QCPSamplingTask : public QRunnable
+{
+public:
+  QCPSamplingTask(const std::function<void()> &function, QSemaphore *finished) : mFunction(function), mFinished(finished) {}
+  virtual void run() Q_DECL_OVERRIDE { mFunction(); mFinished->release(); }
+  
+private:
+  std::function<void()> mFunction;
+  QSemaphore *mFinished;
+};
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////// QCPGraph
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -20880,7 +21242,9 @@ QCPGraph::QCPGraph(QCPAxis *keyAxis, QCPAxis *valueAxis) :
   QCPAbstractPlottable1D<QCPGraphData>(keyAxis, valueAxis),
   mLineStyle{},
   mScatterSkip{},
-  mAdaptiveSampling{}
+  mAdaptiveSampling{},
+  mDecimationPyramid(false),
+  mParallelSampling(false)
 {
   // special handling for QCPGraphs to maintain the simple graph interface:
   mParentPlot->registerGraph(this);
@@ -20916,6 +21280,7 @@ QCPGraph::~QCPGraph()
 void QCPGraph::setData(QSharedPointer<QCPGraphDataContainer> data)
 {
   mDataContainer = data;
+  mPyramid.clear();
 }
 
 /*! \overload
@@ -20932,6 +21297,7 @@ void QCPGraph::setData(QSharedPointer<QCPGraphDataContainer> data)
 void QCPGraph::setData(const QVector<double> &keys, const QVector<double> &values, bool alreadySorted)
 {
   mDataContainer->clear();
+  mPyramid.clear();
   addData(keys, values, alreadySorted);
 }
 
@@ -21038,6 +21404,45 @@ void QCPGraph::setAdaptiveSampling(bool enabled)
   mAdaptiveSampling = enabled;
 }
 
+/*!
+  Sets whether adaptive sampling (\ref setAdaptiveSampling) shall take the value range of each
+  pixel column from a min/max pyramid of the data (\ref QCPGraphDataPyramid), instead of visiting
+  every visible data point. The replot cost then grows with the pixel width of the graph and only
+  logarithmically with the number of points, which keeps pan and zoom responsive on captures of
+  tens of millions of points. The line looks the same as with plain adaptive sampling.
+  
+  The pyramid takes about an eighth of the memory of the data. It is built on the next replot and
+  only extended while points are appended, e.g. with \ref addData. If you modify values in place
+  through \ref data, call \ref invalidateDecimationPyramid afterwards.
+  
+  Only line plots use the pyramid. It is disabled by default.
+*/
+void QCPGraph::setDecimationPyramid(bool enabled)
+{
+  mDecimationPyramid = enabled;
+  if (!enabled)
+    mPyramid.clear();
+}
+
+/*!
+  Sets whether adaptive sampling (\ref setAdaptiveSampling) may split the visible data into chunks
+  and sample them concurrently on QThreadPool::globalInstance(). Chunks start on pixel column
+  boundaries, so the drawn line is identical to the one of a single walk. Only ranges of several
+  hundred thousand points are split, and if the pool has no idle thread, the calling thread samples
+  the remaining chunks itself.
+  
+  The data container must not be modified from other threads during a replot, which holds for
+  sequential sampling as well. When the decimation pyramid is enabled (\ref setDecimationPyramid),
+  it is used instead and this setting has no effect.
+  
+  Parallel sampling is disabled by default, so replots stay on the calling thread unless a graph
+  opts in.
+*/
+void QCPGraph::setParallelSampling(bool enabled)
+{
+  mParallelSampling = enabled;
+}
+
 /*! \overload
   
   Adds the provided points in \a keys and \a values to the current data. The provided vectors
@@ -21066,6 +21471,13 @@ void QCPGraph::addData(const QVector<double> &keys, const QVector<double> &value
     ++it;
     ++i;
   }
+  // the decimation pyramid extends itself on appends, anything inserted at or before the current last key needs a rebuild:
+  if (n > 0 && !mDataContainer->isEmpty())
+  {
+    const double firstNewKey = alreadySorted ? keys.first() : *std::min_element(keys.constBegin(), keys.constBegin()+n);
+    if (firstNewKey <= (mDataContainer->constEnd()-1)->key)
+      mPyramid.clear();
+  }
   mDataContainer->add(tempData, alreadySorted); // don't modify tempData beyond this to prevent copy on write
 }
 
@@ -21078,9 +21490,21 @@ void QCPGraph::addData(const QVector<double> &keys, const QVector<double> &value
 */
 void QCPGraph::addData(double key, double value)
 {
+  if (!mDataContainer->isEmpty() && key <= (mDataContainer->constEnd()-1)->key)
+    mPyramid.clear();
   mDataContainer->add(QCPGraphData(key, value));
 }
 
+/*!
+  Discards the decimation pyramid (see \ref setDecimationPyramid), so the next replot rebuilds it.
+  Call this after changing values of the data container in place, which the pyramid can't detect on
+  its own.
+*/
+void QCPGraph::invalidateDecimationPyramid()
+{
+  mPyramid.clear();
+}
+
 /*!
   Implements a selectTest specific to this plottable's point geometry.
 
@@ -21712,60 +22136,71 @@ void QCPGraph::getOptimizedLineData(QVector<QCPGraphData> *lineData, const QCPGr
   
   if (mAdaptiveSampling && dataCount >= maxCount) // use adaptive sampling only if there are at least two points per pixel on average
   {
-    QCPGraphDataContainer::const_iterator it = begin;
-    double minValue = it->value;
-    double maxValue = it->value;
-    QCPGraphDataContainer::const_iterator currentIntervalFirstPoint = it;
-    int reversedFactor = keyAxis->pixelOrientation(); // is used to calculate keyEpsilon pixel into the correct direction
-    int reversedRound = reversedFactor==-1 ? 1 : 0; // is used to switch between floor (normal) and ceil (reversed) rounding of currentIntervalStartKey
-    double currentIntervalStartKey = keyAxis->pixelToCoord(int(keyAxis->coordToPixel(begin->key)+reversedRound));
-    double lastIntervalEndKey = currentIntervalStartKey;
-    double keyEpsilon = qAbs(currentIntervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(currentIntervalStartKey)+1.0*reversedFactor)); // interval of one pixel on screen when mapped to plot key coordinates
-    bool keyEpsilonVariable = keyAxis->scaleType() == QCPAxis::stLogarithmic; // indicates whether keyEpsilon needs to be updated after every interval (for log axes)
-    int intervalDataCount = 1;
-    ++it; // advance iterator to second data point because adaptive sampling works in 1 point retrospect
-    while (it != end)
+    if (mDecimationPyramid)
+    {
+      getPyramidLineData(lineData, begin, end);
+      return;
+    }
+    const int reversedFactor = keyAxis->pixelOrientation();
+    const int reversedRound = reversedFactor==-1 ? 1 : 0;
+    const double firstIntervalStartKey = keyAxis->pixelToCoord(int(keyAxis->coordToPixel(begin->key)+reversedRound));
+    const double keyEpsilon = qAbs(firstIntervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(firstIntervalStartKey)+1.0*reversedFactor)); // interval of one pixel on screen when mapped to plot key coordinates
+    QThreadPool *pool = QThreadPool::globalInstance();
+    const int chunkCount = mParallelSampling ? qBound(1, dataCount/qcpMinSamplingChunkSize, pool->maxThreadCount()) : 1;
+    if (chunkCount == 1)
     {
-      if (it->key < currentIntervalStartKey+keyEpsilon) // data point is still within same pixel, so skip it and expand value span of this cluster if necessary
+      getAdaptiveLineChunk(lineData, begin, end, end, firstIntervalStartKey, keyEpsilon);
+      return;
+    }
+    
+    // split the range at pixel column boundaries, so the chunks yield exactly the clusters of a single walk:
+    QVector<QCPGraphDataContainer::const_iterator> chunkBounds;
+    chunkBounds << begin;
+    const double beginPixel = keyAxis->coordToPixel(begin->key);
+    const double endPixel = keyAxis->coordToPixel((end-1)->key);
+    for (int i=1; i<chunkCount; ++i)
+    {
+      const double boundaryKey = keyAxis->pixelToCoord(qRound(beginPixel+(endPixel-beginPixel)*i/chunkCount));
+      const QCPGraphDataContainer::const_iterator boundary = std::lower_bound(chunkBounds.last(), end, boundaryKey,
+        [](const QCPGraphData &data, double key) { return data.key < key; });
+      if (boundary != chunkBounds.last() && boundary != end)
+        chunkBounds << boundary;
+    }
+    chunkBounds << end;
+    
+    // the calling thread takes the first chunk, the pool the others (or the calling thread too, if the pool is busy):
+    QVector<QVector<QCPGraphData> > chunkData(chunkBounds.size()-1);
+    QSemaphore finished;
+    int pooled = 0;
+    for (int i=1; i<chunkData.size(); ++i)
+    {
+      QVector<QCPGraphData> *chunkLineData = &chunkData[i];
+      const QCPGraphDataContainer::const_iterator chunkBegin = chunkBounds.at(i);
+      const QCPGraphDataContainer::const_iterator chunkEnd = chunkBounds.at(i+1);
+      const QCPGraphDataContainer::const_iterator dataEnd = end;
+      QCPSamplingTask *task = new QCPSamplingTask([this, chunkLineData, chunkBegin, chunkEnd, dataEnd, keyEpsilon]()
       {
-        if (it->value < minValue)
-          minValue = it->value;
-        else if (it->value > maxValue)
-          maxValue = it->value;
-        ++intervalDataCount;
-      } else // new pixel interval started
+        getAdaptiveLineChunk(chunkLineData, chunkBegin, chunkEnd, dataEnd, (chunkBegin-1)->key, keyEpsilon);
+      }, &finished);
+      if (pool->tryStart(task))
       {
-        if (intervalDataCount >= 2) // last pixel had multiple data points, consolidate them to a cluster
-        {
-          if (lastIntervalEndKey < currentIntervalStartKey-keyEpsilon) // last point is further away, so first point of this cluster must be at a real data point
-            lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.2, currentIntervalFirstPoint->value));
-          lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.25, minValue));
-          lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.75, maxValue));
-          if (it->key > currentIntervalStartKey+keyEpsilon*2) // new pixel started further away from previous cluster, so make sure the last point of the cluster is at a real data point
-            lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.8, (it-1)->value));
-        } else
-          lineData->append(QCPGraphData(currentIntervalFirstPoint->key, currentIntervalFirstPoint->value));
-        lastIntervalEndKey = (it-1)->key;
-        minValue = it->value;
-        maxValue = it->value;
-        currentIntervalFirstPoint = it;
-        currentIntervalStartKey = keyAxis->pixelToCoord(int(keyAxis->coordToPixel(it->key)+reversedRound));
-        if (keyEpsilonVariable)
-          keyEpsilon = qAbs(currentIntervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(currentIntervalStartKey)+1.0*reversedFactor));
-        intervalDataCount = 1;
+        ++pooled;
+      } else
+      {
+        task->run();
+        delete task;
+        finished.acquire();
       }
-      ++it;
     }
-    // handle last interval:
-    if (intervalDataCount >= 2) // last pixel had multiple data points, consolidate them to a cluster
-    {
-      if (lastIntervalEndKey < currentIntervalStartKey-keyEpsilon) // last point wasn't a cluster, so first point of this cluster must be at a real data point
-        lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.2, currentIntervalFirstPoint->value));
-      lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.25, minValue));
-      lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.75, maxValue));
-    } else
-      lineData->append(QCPGraphData(currentIntervalFirstPoint->key, currentIntervalFirstPoint->value));
+    getAdaptiveLineChunk(&chunkData[0], begin, chunkBounds.at(1), end, firstIntervalStartKey, keyEpsilon);
+    finished.acquire(pooled);
     
+    int lineDataSize = lineData->size();
+    for (int i=0; i<chunkData.size(); ++i)
+      lineDataSize += chunkData.at(i).size();
+    lineData->reserve(lineDataSize);
+    for (int i=0; i<chunkData.size(); ++i)
+      *lineData += chunkData.at(i);
   } else // don't use adaptive sampling algorithm, transfer points one-to-one from the data container into the output
   {
     lineData->resize(dataCount);
@@ -21773,6 +22208,124 @@ void QCPGraph::getOptimizedLineData(QVector<QCPGraphData> *lineData, const QCPGr
   }
 }
 
+/*! \internal
+
+  Runs the adaptive sampling of \ref getOptimizedLineData over the data points from \a begin up to
+  \a end and appends the resulting clusters to \a lineData.
+  
+  \a dataEnd is the end of the whole range being sampled. If \a end isn't \a dataEnd, the point at
+  \a end decides whether the last cluster gets a closing point, just like the first point of the
+  next pixel interval does during a single walk. \a lastIntervalEndKey is the key of the point
+  before \a begin, or the start key of the first pixel interval if \a begin is the start of the
+  range. \a keyEpsilon is the key span of one pixel at the start of the range; it is passed in
+  rather than recomputed per chunk so all chunks of a linear axis round identically.
+  
+  Chunks that start on pixel column boundaries can be sampled concurrently, see \ref
+  setParallelSampling.
+*/
+void QCPGraph::getAdaptiveLineChunk(QVector<QCPGraphData> *lineData, QCPGraphDataContainer::const_iterator begin, QCPGraphDataContainer::const_iterator end, QCPGraphDataContainer::const_iterator dataEnd, double lastIntervalEndKey, double keyEpsilon) const
+{
+  QCPAxis *keyAxis = mKeyAxis.data();
+  QCPGraphDataContainer::const_iterator it = begin;
+  double minValue = it->value;
+  double maxValue = it->value;
+  QCPGraphDataContainer::const_iterator currentIntervalFirstPoint = it;
+  int reversedFactor = keyAxis->pixelOrientation(); // is used to calculate keyEpsilon pixel into the correct direction
+  int reversedRound = reversedFactor==-1 ? 1 : 0; // is used to switch between floor (normal) and ceil (reversed) rounding of currentIntervalStartKey
+  double currentIntervalStartKey = keyAxis->pixelToCoord(int(keyAxis->coordToPixel(begin->key)+reversedRound));
+  bool keyEpsilonVariable = keyAxis->scaleType() == QCPAxis::stLogarithmic; // indicates whether keyEpsilon needs to be updated after every interval (for log axes)
+  if (keyEpsilonVariable)
+    keyEpsilon = qAbs(currentIntervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(currentIntervalStartKey)+1.0*reversedFactor)); // interval of one pixel on screen when mapped to plot key coordinates
+  int intervalDataCount = 1;
+  ++it; // advance iterator to second data point because adaptive sampling works in 1 point retrospect
+  while (it != end)
+  {
+    if (it->key < currentIntervalStartKey+keyEpsilon) // data point is still within same pixel, so skip it and expand value span of this cluster if necessary
+    {
+      if (it->value < minValue)
+        minValue = it->value;
+      else if (it->value > maxValue)
+        maxValue = it->value;
+      ++intervalDataCount;
+    } else // new pixel interval started
+    {
+      if (intervalDataCount >= 2) // last pixel had multiple data points, consolidate them to a cluster
+      {
+        if (lastIntervalEndKey < currentIntervalStartKey-keyEpsilon) // last point is further away, so first point of this cluster must be at a real data point
+          lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.2, currentIntervalFirstPoint->value));
+        lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.25, minValue));
+        lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.75, maxValue));
+        if (it->key > currentIntervalStartKey+keyEpsilon*2) // new pixel started further away from previous cluster, so make sure the last point of the cluster is at a real data point
+          lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.8, (it-1)->value));
+      } else
+        lineData->append(QCPGraphData(currentIntervalFirstPoint->key, currentIntervalFirstPoint->value));
+      lastIntervalEndKey = (it-1)->key;
+      minValue = it->value;
+      maxValue = it->value;
+      currentIntervalFirstPoint = it;
+      currentIntervalStartKey = keyAxis->pixelToCoord(int(keyAxis->coordToPixel(it->key)+reversedRound));
+      if (keyEpsilonVariable)
+        keyEpsilon = qAbs(currentIntervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(currentIntervalStartKey)+1.0*reversedFactor));
+      intervalDataCount = 1;
+    }
+    ++it;
+  }
+  // handle last interval:
+  if (intervalDataCount >= 2) // last pixel had multiple data points, consolidate them to a cluster
+  {
+    if (lastIntervalEndKey < currentIntervalStartKey-keyEpsilon) // last point wasn't a cluster, so first point of this cluster must be at a real data point
+      lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.2, currentIntervalFirstPoint->value));
+    lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.25, minValue));
+    lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.75, maxValue));
+    if (end != dataEnd && end->key > currentIntervalStartKey+keyEpsilon*2) // next chunk starts further away from this cluster, so make sure the last point of the cluster is at a real data point
+      lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.8, (end-1)->value));
+  } else
+    lineData->append(QCPGraphData(currentIntervalFirstPoint->key, currentIntervalFirstPoint->value));
+}
+
+/*! \internal
+
+  Adaptive sampling like in \ref getOptimizedLineData, but instead of walking the data point by
+  point, each pixel interval is found by binary search and its value range comes from the decimation
+  pyramid (see \ref setDecimationPyramid). The cost is O(p log n) for p pixels and n data points,
+  and the resulting clusters match the ones of the linear walk.
+*/
+void QCPGraph::getPyramidLineData(QVector<QCPGraphData> *lineData, const QCPGraphDataContainer::const_iterator &begin, const QCPGraphDataContainer::const_iterator &end) const
+{
+  QCPAxis *keyAxis = mKeyAxis.data();
+  mPyramid.update(mDataContainer.data());
+  const QCPGraphDataContainer::const_iterator dataBegin = mDataContainer->constBegin();
+  const int reversedFactor = keyAxis->pixelOrientation(); // is used to calculate keyEpsilon pixel into the correct direction
+  const int reversedRound = reversedFactor==-1 ? 1 : 0; // is used to switch between floor (normal) and ceil (reversed) rounding of intervalStartKey
+  const bool keyEpsilonVariable = keyAxis->scaleType() == QCPAxis::stLogarithmic; // indicates whether keyEpsilon needs to be updated after every interval (for log axes)
+  double keyEpsilon = 0;
+  double lastIntervalEndKey = keyAxis->pixelToCoord(int(keyAxis->coordToPixel(begin->key)+reversedRound));
+  QCPGraphDataContainer::const_iterator it = begin;
+  while (it != end)
+  {
+    const double intervalStartKey = keyAxis->pixelToCoord(int(keyAxis->coordToPixel(it->key)+reversedRound));
+    if (it == begin || keyEpsilonVariable)
+      keyEpsilon = qAbs(intervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(intervalStartKey)+1.0*reversedFactor)); // interval of one pixel on screen when mapped to plot key coordinates
+    // the interval holds every following point with a key below intervalStartKey+keyEpsilon:
+    const QCPGraphDataContainer::const_iterator intervalEnd = std::lower_bound(it+1, end, intervalStartKey+keyEpsilon,
+      [](const QCPGraphData &data, double key) { return data.key < key; });
+    if (intervalEnd-it >= 2) // multiple data points in this pixel, consolidate them to a cluster
+    {
+      const QCPRange bounds = mPyramid.valueBounds(int(it-dataBegin), int(intervalEnd-dataBegin));
+      const bool hasValues = bounds.lower <= bounds.upper;
+      if (lastIntervalEndKey < intervalStartKey-keyEpsilon) // last point is further away, so first point of this cluster must be at a real data point
+        lineData->append(QCPGraphData(intervalStartKey+keyEpsilon*0.2, it->value));
+      lineData->append(QCPGraphData(intervalStartKey+keyEpsilon*0.25, hasValues ? bounds.lower : qQNaN()));
+      lineData->append(QCPGraphData(intervalStartKey+keyEpsilon*0.75, hasValues ? bounds.upper : qQNaN()));
+      if (intervalEnd != end && intervalEnd->key > intervalStartKey+keyEpsilon*2) // next pixel starts further away from this cluster, so make sure the last point of the cluster is at a real data point
+        lineData->append(QCPGraphData(intervalStartKey+keyEpsilon*0.8, (intervalEnd-1)->value));
+    } else
+      lineData->append(QCPGraphData(it->key, it->value));
+    lastIntervalEndKey = (intervalEnd-1)->key;
+    it = intervalEnd;
+  }
+}
+
 /*! \internal
 
   Returns via \a scatterData the data points that need to be visualized for this graph when
@@ -22489,52 +23042,539 @@ int QCPGraph::findIndexBelowY(const QVector<QPointF> *data, double y) const
   }
   return -1;
 }
-/* end of 'src/plottables/plottable-graph.cpp' */
-
-
-/* including file 'src/plottables/plottable-curve.cpp' */
-/* modified 2022-11-06T12:45:56, size 63851            */
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
-//////////////////// QCPCurveData
+//////////////////// QCPSampleGraph
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-/*! \class QCPCurveData
-  \brief Holds the data of one single data point for QCPCurve.
-  
-  The stored data is:
-  \li \a t: the free ordering parameter of this curve point, like in the mathematical vector <em>(x(t), y(t))</em>. (This is the \a sortKey)
-  \li \a key: coordinate on the key axis of this curve point (this is the \a mainKey)
-  \li \a value: coordinate on the value axis of this curve point (this is the \a mainValue)
-  
-  The container for storing multiple data points is \ref QCPCurveDataContainer. It is a typedef for
-  \ref QCPDataContainer with \ref QCPCurveData as the DataType template parameter. See the
-  documentation there for an explanation regarding the data type's generic methods.
-  
-  \see QCPCurveDataContainer
-*/
+/*! \class QCPSampleGraph
+  \brief A line through uniformly sampled values that live in an external buffer
 
-/* start documentation of inline functions */
+  QCPSampleGraph draws an array of float samples owned by the application, typically an audio or
+  acquisition buffer. Sample \a i is placed at the key <tt>firstKey + i*keyStep</tt>, so no keys
+  are stored and no QCPGraphData is created for the samples. Binding a buffer with \ref setSamples
+  copies nothing; after its contents change, a replot shows them.
 
-/*! \fn double QCPCurveData::sortKey() const
-  
-  Returns the \a t member of this data point.
-  
-  For a general explanation of what this method is good for in the context of the data container,
-  see the documentation of \ref QCPDataContainer.
-*/
+  Because the keys are implicit, the visible samples are found by index arithmetic instead of a
+  binary search. If there are at least two samples per pixel, each pixel column is reduced to its
+  first, smallest, largest and last sample, so the line looks like the one of a QCPGraph with
+  adaptive sampling while only a few points per pixel reach the painter.
 
-/*! \fn static QCPCurveData QCPCurveData::fromSortKey(double sortKey)
+  Alternatively, \ref setData and \ref addData let the graph own its samples. It then stores only
+  the values as floats, a quarter of the memory of QCPGraphData, and still needs no key lookups.
   
-  Returns a data point with the specified \a sortKey (assigned to the data point's \a t member).
-  All other members are set to zero.
-  
-  For a general explanation of what this method is good for in the context of the data container,
-  see the documentation of \ref QCPDataContainer.
+  On linear axes, key and value map to pixels through one affine transform each, which is applied
+  to whole runs of samples (with SSE2 where available) instead of calling QCPAxis::coordToPixel per
+  point. The per-column minimum and maximum are vectorized the same way. Logarithmic axes use the
+  regular coordinate conversion.
+
+  An external buffer must stay valid as long as it is bound. The graph is drawn with \ref setPen;
+  it has no fill, no scatters and no data point selection (clicking it selects the whole graph).
+  NaN samples break the line where they are drawn.
 */
 
-/*! \fn static static bool QCPCurveData::sortKeyIsMainKey()
-  
+/* start of documentation of inline functions */
+
+/*! \fn double QCPSampleGraph::sampleKey(int index) const
+
+  Returns the key at which the sample with \a index is drawn.
+*/
+
+/* end of documentation of inline functions */
+
+/*!
+  Constructs a sample graph which uses \a keyAxis as its key axis ("x") and \a valueAxis as its
+  value axis ("y"). \a keyAxis and \a valueAxis must reside in the same QCustomPlot instance and
+  not have the same orientation. If either of these restrictions is violated, a corresponding
+  message is printed to the debug output (qDebug), the construction is not aborted, though.
+
+  The created QCPSampleGraph is automatically registered with the QCustomPlot instance inferred
+  from \a keyAxis. This QCustomPlot instance takes ownership of the QCPSampleGraph, so do not
+  delete it manually but use QCustomPlot::removePlottable() instead.
+*/
+QCPSampleGraph::QCPSampleGraph(QCPAxis *keyAxis, QCPAxis *valueAxis) :
+  QCPAbstractPlottable(keyAxis, valueAxis),
+  mSamples(nullptr),
+  mSampleCount(0),
+  mKeyStep(1),
+  mFirstKey(0)
+{
+  setPen(QPen(Qt::blue, 0));
+  setBrush(Qt::NoBrush);
+}
+
+QCPSampleGraph::~QCPSampleGraph()
+{
+}
+
+/*!
+  Binds the graph to the \a count float values at \a samples, without copying them. Sample \a i
+  is drawn at key <tt>firstKey + i*keyStep</tt>, e.g. pass the sampling interval as \a keyStep to
+  get a time axis in seconds.
+
+  The graph reads the buffer on every replot, so it must stay valid and unchanged in size until it
+  is unbound by passing a null pointer, or another buffer is set. Values previously passed to \ref
+  setData are released. \a keyStep must be positive.
+  
+  \see setData
+*/
+void QCPSampleGraph::setSamples(const float *samples, int count, double keyStep, double firstKey)
+{
+  if (keyStep <= 0)
+  {
+    qDebug() << Q_FUNC_INFO << "key step must be positive:" << keyStep;
+    return;
+  }
+  mOwnedSamples = QVector<float>();
+  mSamples = samples;
+  mSampleCount = samples ? qMax(0, count) : 0;
+  mKeyStep = keyStep;
+  mFirstKey = firstKey;
+}
+
+/*!
+  Replaces the samples with \a values, which the graph keeps (sharing, not copying, the QVector).
+  Like with \ref setSamples, sample \a i is drawn at key <tt>firstKey + i*keyStep</tt> and no keys
+  are stored. \a keyStep must be positive.
+  
+  \see addData
+*/
+void QCPSampleGraph::setData(const QVector<float> &values, double keyStep, double firstKey)
+{
+  if (keyStep <= 0)
+  {
+    qDebug() << Q_FUNC_INFO << "key step must be positive:" << keyStep;
+    return;
+  }
+  mOwnedSamples = values;
+  mSamples = mOwnedSamples.constData();
+  mSampleCount = mOwnedSamples.size();
+  mKeyStep = keyStep;
+  mFirstKey = firstKey;
+}
+
+/*!
+  Appends the \a count floats at \a values to the samples, continuing the uniform keys. If the graph
+  is bound to an external buffer (\ref setSamples), its samples are copied into the graph first.
+  
+  \see setData
+*/
+void QCPSampleGraph::addData(const float *values, int count)
+{
+  if (!values || count <= 0)
+    return;
+  if (mSamples != mOwnedSamples.constData()) // take over the samples of an external buffer
+  {
+    QVector<float> owned(mSampleCount);
+    std::copy(mSamples, mSamples+mSampleCount, owned.begin());
+    mOwnedSamples = owned;
+  }
+  mOwnedSamples.resize(mSampleCount+count);
+  std::copy(values, values+count, mOwnedSamples.begin()+mSampleCount);
+  mSamples = mOwnedSamples.constData();
+  mSampleCount = mOwnedSamples.size();
+}
+
+/*!
+  Implements a selectTest specific to this plottable's line. If \a details is not 0, it is set to
+  a \ref QCPDataSelection covering the whole graph, since single samples can't be selected.
+
+  \seebaseclassmethod \ref QCPAbstractPlottable::selectTest
+*/
+double QCPSampleGraph::selectTest(const QPointF &pos, bool onlySelectable, QVariant *details) const
+{
+  if ((onlySelectable && mSelectable == QCP::stNone) || mSampleCount == 0)
+    return -1;
+  if (!mKeyAxis || !mValueAxis)
+    return -1;
+  
+  if (mKeyAxis.data()->axisRect()->rect().contains(pos.toPoint()) || mParentPlot->interactions().testFlag(QCP::iSelectPlottablesBeyondAxisRect))
+  {
+    QVector<QPointF> lines;
+    getLines(&lines);
+    const QCPVector2D p(pos);
+    double minDistSqr = (std::numeric_limits<double>::max)();
+    for (int i=0; i<lines.size()-1; ++i)
+    {
+      if (qIsNaN(lines.at(i).x()) || qIsNaN(lines.at(i).y()) || qIsNaN(lines.at(i+1).x()) || qIsNaN(lines.at(i+1).y()))
+        continue;
+      const double currentDistSqr = p.distanceSquaredToLine(lines.at(i), lines.at(i+1));
+      if (currentDistSqr < minDistSqr)
+        minDistSqr = currentDistSqr;
+    }
+    if (minDistSqr == (std::numeric_limits<double>::max)())
+      return -1;
+    if (details)
+      details->setValue(QCPDataSelection(QCPDataRange(0, 1))); // whole-plottable selection, like QCPColorMap
+    return qSqrt(minDistSqr);
+  }
+  return -1;
+}
+
+/* inherits documentation from base class */
+QCPRange QCPSampleGraph::getKeyRange(bool &foundRange, QCP::SignDomain inSignDomain) const
+{
+  foundRange = false;
+  int begin = 0;
+  int end = mSampleCount;
+  if (inSignDomain == QCP::sdPositive)
+    begin = sampleIndexAbove(0, false);
+  else if (inSignDomain == QCP::sdNegative)
+    end = sampleIndexAbove(0, true);
+  if (begin >= end)
+    return QCPRange();
+  foundRange = true;
+  return QCPRange(sampleKey(begin), sampleKey(end-1));
+}
+
+/* inherits documentation from base class */
+QCPRange QCPSampleGraph::getValueRange(bool &foundRange, QCP::SignDomain inSignDomain, const QCPRange &inKeyRange) const
+{
+  int begin = 0;
+  int end = mSampleCount;
+  if (inKeyRange != QCPRange())
+  {
+    begin = sampleIndexAbove(inKeyRange.lower, true);
+    end = sampleIndexAbove(inKeyRange.upper, false);
+  }
+  QCPRange range((std::numeric_limits<double>::max)(), -(std::numeric_limits<double>::max)());
+  for (int i=begin; i<end; ++i)
+  {
+    const double value = mSamples[i];
+    if (qIsNaN(value))
+      continue;
+    if ((inSignDomain == QCP::sdPositive && value <= 0) || (inSignDomain == QCP::sdNegative && value >= 0))
+      continue;
+    if (value < range.lower)
+      range.lower = value;
+    if (value > range.upper)
+      range.upper = value;
+  }
+  foundRange = range.lower <= range.upper;
+  return foundRange ? range : QCPRange();
+}
+
+/* inherits documentation from base class */
+void QCPSampleGraph::draw(QCPPainter *painter)
+{
+  if (!mKeyAxis || !mValueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
+  if (mKeyAxis.data()->range().size() <= 0 || mSampleCount == 0) return;
+  
+  QVector<QPointF> lines;
+  getLines(&lines);
+  
+  if (selected() && mSelectionDecorator)
+    mSelectionDecorator->applyPen(painter);
+  else
+    painter->setPen(mPen);
+  painter->setBrush(Qt::NoBrush);
+  if (painter->pen().style() != Qt::NoPen && painter->pen().color().alpha() != 0)
+  {
+    applyDefaultAntialiasingHint(painter);
+    // draw the runs of points between NaN samples as separate polylines:
+    int segmentBegin = 0;
+    for (int i=0; i<=lines.size(); ++i)
+    {
+      if (i == lines.size() || qIsNaN(lines.at(i).x()) || qIsNaN(lines.at(i).y()))
+      {
+        if (i-segmentBegin >= 2)
+          painter->drawPolyline(lines.constData()+segmentBegin, i-segmentBegin);
+        segmentBegin = i+1;
+      }
+    }
+  }
+  
+  if (mSelectionDecorator)
+    mSelectionDecorator->drawDecoration(painter, selection());
+}
+
+/* inherits documentation from base class */
+void QCPSampleGraph::drawLegendIcon(QCPPainter *painter, const QRectF &rect) const
+{
+  applyDefaultAntialiasingHint(painter);
+  painter->setPen(mPen);
+  painter->drawLine(QLineF(rect.left(), rect.top()+rect.height()/2.0, rect.right()+5, rect.top()+rect.height()/2.0)); // +5 on x2 else last segment is missing from dashed/dotted pens
+}
+
+/*! \internal
+
+  Returns the index of the first sample whose key is greater than \a key, or greater than or equal
+  to it if \a inclusive is true. The result is clamped to the range 0 to \ref sampleCount.
+*/
+int QCPSampleGraph::sampleIndexAbove(double key, bool inclusive) const
+{
+  const double position = qBound(-1.0, (key-mFirstKey)/mKeyStep, double(mSampleCount)); // clamp first, so the rounding can't overflow int
+  const double index = inclusive ? std::ceil(position) : std::floor(position)+1;
+  return int(qBound(0.0, index, double(mSampleCount)));
+}
+
+/*! \internal
+
+  Returns via \a begin and \a end the range of sample indices within the key axis range, plus the
+  sample just outside on either side so the line reaches the axis rect border. Unlike the binary
+  search of QCPGraph, this is plain index arithmetic.
+*/
+void QCPSampleGraph::getVisibleIndexRange(int &begin, int &end) const
+{
+  const QCPRange keyRange = mKeyAxis.data()->range();
+  begin = qMax(0, sampleIndexAbove(keyRange.lower, true)-1);
+  end = qMin(mSampleCount, sampleIndexAbove(keyRange.upper, false)+1);
+}
+
+/*! \internal
+
+  Returns via \a lines the pixel coordinates of the line through the visible samples. If there are
+  at least two samples per pixel, each pixel column is reduced to its first sample, its smallest
+  and largest sample, and its last sample, like the adaptive sampling of QCPGraph. Otherwise every
+  sample becomes one point.
+  
+  On linear axes this uses \ref getAffineLines, otherwise \ref getMappedLines.
+*/
+void QCPSampleGraph::getLines(QVector<QPointF> *lines) const
+{
+  lines->clear();
+  QCPAxis *keyAxis = mKeyAxis.data();
+  QCPAxis *valueAxis = mValueAxis.data();
+  if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
+  int begin, end;
+  getVisibleIndexRange(begin, end);
+  if (begin >= end)
+    return;
+  if (keyAxis->scaleType() == QCPAxis::stLinear && valueAxis->scaleType() == QCPAxis::stLinear)
+    getAffineLines(lines, begin, end);
+  else
+    getMappedLines(lines, begin, end);
+}
+
+/*! \internal
+
+  Returns via \a lower and \a upper the smallest and largest of the \a count floats at \a values,
+  ignoring NaN. Returns false if there are no other values.
+*/
+static bool qcpSampleBounds(const float *values, int count, float &lower, float &upper)
+{
+  float low = std::numeric_limits<float>::infinity();
+  float high = -std::numeric_limits<float>::infinity();
+  int i = 0;
+#ifdef __SSE2__
+  if (count >= 8)
+  {
+    __m128 low4 = _mm_set1_ps(low);
+    __m128 high4 = _mm_set1_ps(high);
+    for (; i+4<=count; i+=4)
+    {
+      const __m128 v = _mm_loadu_ps(values+i);
+      low4 = _mm_min_ps(v, low4); // minps/maxps return the second operand if the first is NaN, which skips NaN samples
+      high4 = _mm_max_ps(v, high4);
+    }
+    float lows[4], highs[4];
+    _mm_storeu_ps(lows, low4);
+    _mm_storeu_ps(highs, high4);
+    for (int k=0; k<4; ++k)
+    {
+      low = qMin(low, lows[k]);
+      high = qMax(high, highs[k]);
+    }
+  }
+#endif
+  for (; i<count; ++i)
+  {
+    if (values[i] < low)
+      low = values[i];
+    if (values[i] > high)
+      high = values[i];
+  }
+  lower = low;
+  upper = high;
+  return low <= high;
+}
+
+/*! \internal
+
+  Writes the pixel positions of the \a count samples at \a values to \a points. Sample \a i lies
+  at key pixel <tt>keyPixel + i*keyPixelStep</tt> and value pixel <tt>valueScale*value +
+  valueOffset</tt>. \a keyVertical swaps the coordinates for vertical key axes.
+*/
+static void qcpAffinePoints(const float *values, int count, double keyPixel, double keyPixelStep, double valueScale, double valueOffset, bool keyVertical, QPointF *points)
+{
+  int i = 0;
+#ifdef __SSE2__
+  if (sizeof(QPointF) == 2*sizeof(double)) // qreal is double, so points are pairs of doubles
+  {
+    double *out = reinterpret_cast<double*>(points);
+    const __m128d scale = _mm_set1_pd(valueScale);
+    const __m128d offset = _mm_set1_pd(valueOffset);
+    const __m128d keyStart = _mm_set1_pd(keyPixel);
+    const __m128d keyStep = _mm_set1_pd(keyPixelStep);
+    __m128d index = _mm_set_pd(1, 0);
+    for (; i+2<=count; i+=2)
+    {
+      const __m128d value = _mm_cvtps_pd(_mm_castsi128_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(values+i))));
+      const __m128d valuePixel = _mm_add_pd(_mm_mul_pd(value, scale), offset);
+      const __m128d key = _mm_add_pd(keyStart, _mm_mul_pd(index, keyStep));
+      if (keyVertical)
+      {
+        _mm_storeu_pd(out+2*i, _mm_unpacklo_pd(valuePixel, key));
+        _mm_storeu_pd(out+2*i+2, _mm_unpackhi_pd(valuePixel, key));
+      } else
+      {
+        _mm_storeu_pd(out+2*i, _mm_unpacklo_pd(key, valuePixel));
+        _mm_storeu_pd(out+2*i+2, _mm_unpackhi_pd(key, valuePixel));
+      }
+      index = _mm_add_pd(index, _mm_set1_pd(2));
+    }
+  }
+#endif
+  for (; i<count; ++i)
+  {
+    const double key = keyPixel+i*keyPixelStep;
+    const double valuePixel = valueScale*values[i]+valueOffset;
+    points[i] = keyVertical ? QPointF(valuePixel, key) : QPointF(key, valuePixel);
+  }
+}
+
+/*! \internal
+
+  Line generation of \ref getLines for linear axes. Key and value of the samples from \a begin to
+  \a end map to pixels through one affine transform each, so the samples of a pixel column are
+  found by index arithmetic and whole runs of samples are transformed at once.
+*/
+void QCPSampleGraph::getAffineLines(QVector<QPointF> *lines, int begin, int end) const
+{
+  QCPAxis *keyAxis = mKeyAxis.data();
+  QCPAxis *valueAxis = mValueAxis.data();
+  const bool keyVertical = keyAxis->orientation() == Qt::Vertical;
+  const double beginPixel = keyAxis->coordToPixel(sampleKey(begin));
+  const double endPixel = keyAxis->coordToPixel(sampleKey(end-1));
+  const double keyPixelStep = end-begin > 1 ? (endPixel-beginPixel)/(end-1-begin) : 0; // key pixel distance of neighbouring samples, negative for reversed axes
+  const double valueOffset = valueAxis->coordToPixel(0);
+  const double valueScale = valueAxis->coordToPixel(1)-valueOffset;
+  
+  if (end-begin < 2*qAbs(endPixel-beginPixel)+2) // less than two samples per pixel, connect every sample
+  {
+    lines->resize(end-begin);
+    qcpAffinePoints(mSamples+begin, end-begin, beginPixel, keyPixelStep, valueScale, valueOffset, keyVertical, lines->data());
+    return;
+  }
+  
+  const double direction = keyPixelStep < 0 ? -1 : 1;
+  lines->reserve(4*(int(qAbs(endPixel-beginPixel))+2));
+  QPointF point;
+  int i = begin;
+  while (i < end)
+  {
+    // the column spans the pixels from columnPixel to columnPixel+direction:
+    const double pixel = beginPixel+(i-begin)*keyPixelStep;
+    const double columnPixel = direction > 0 ? std::floor(pixel) : std::ceil(pixel);
+    const double columnEndIndex = begin+std::ceil((columnPixel+direction-beginPixel)/keyPixelStep);
+    const int columnEnd = int(qBound(double(i+1), columnEndIndex, double(end)));
+    qcpAffinePoints(mSamples+i, 1, pixel, 0, valueScale, valueOffset, keyVertical, &point);
+    lines->append(point);
+    float lower, upper;
+    if (columnEnd-i >= 2)
+    {
+      if (qcpSampleBounds(mSamples+i, columnEnd-i, lower, upper))
+      {
+        const double centerPixel = columnPixel+0.5*direction;
+        qcpAffinePoints(&lower, 1, centerPixel, 0, valueScale, valueOffset, keyVertical, &point);
+        lines->append(point);
+        qcpAffinePoints(&upper, 1, centerPixel, 0, valueScale, valueOffset, keyVertical, &point);
+        lines->append(point);
+      }
+      qcpAffinePoints(mSamples+columnEnd-1, 1, beginPixel+(columnEnd-1-begin)*keyPixelStep, 0, valueScale, valueOffset, keyVertical, &point);
+      lines->append(point);
+    }
+    i = columnEnd;
+  }
+}
+
+/*! \internal
+
+  Line generation of \ref getLines for logarithmic axes, where keys and values can't be mapped
+  affinely. Every output point goes through QCPAxis::coordToPixel, the pixel columns are found from
+  their boundary keys.
+*/
+void QCPSampleGraph::getMappedLines(QVector<QPointF> *lines, int begin, int end) const
+{
+  QCPAxis *keyAxis = mKeyAxis.data();
+  const double keyPixelSpan = qAbs(keyAxis->coordToPixel(sampleKey(begin))-keyAxis->coordToPixel(sampleKey(end-1)));
+  if (end-begin < 2*keyPixelSpan+2) // less than two samples per pixel, connect every sample
+  {
+    lines->reserve(end-begin);
+    for (int i=begin; i<end; ++i)
+      lines->append(coordsToPixels(sampleKey(i), mSamples[i]));
+    return;
+  }
+  
+  const int reversedFactor = keyAxis->pixelOrientation(); // is used to step to the next pixel column into the correct direction
+  const int reversedRound = reversedFactor==-1 ? 1 : 0; // is used to switch between floor (normal) and ceil (reversed) rounding of the column pixel
+  lines->reserve(4*(int(keyPixelSpan)+2));
+  int i = begin;
+  while (i < end)
+  {
+    const double columnPixel = int(keyAxis->coordToPixel(sampleKey(i))+reversedRound);
+    const int columnEnd = qBound(i+1, sampleIndexAbove(keyAxis->pixelToCoord(columnPixel+reversedFactor), true), end);
+    lines->append(coordsToPixels(sampleKey(i), mSamples[i]));
+    float lower, upper;
+    if (columnEnd-i >= 2)
+    {
+      if (qcpSampleBounds(mSamples+i, columnEnd-i, lower, upper))
+      {
+        const double columnKey = keyAxis->pixelToCoord(columnPixel+0.5*reversedFactor);
+        lines->append(coordsToPixels(columnKey, lower));
+        lines->append(coordsToPixels(columnKey, upper));
+      }
+      lines->append(coordsToPixels(sampleKey(columnEnd-1), mSamples[columnEnd-1]));
+    }
+    i = columnEnd;
+  }
+}
+/* end of 'src/plottables/plottable-graph.cpp' */
+
+
+/* including file 'src/plottables/plottable-curve.cpp' */
+/* modified 2022-11-06T12:45:56, size 63851            */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPCurveData
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPCurveData
+  \brief Holds the data of one single data point for QCPCurve.
+  
+  The stored data is:
+  \li \a t: the free ordering parameter of this curve point, like in the mathematical vector <em>(x(t), y(t))</em>. (This is the \a sortKey)
+  \li \a key: coordinate on the key axis of this curve point (this is the \a mainKey)
+  \li \a value: coordinate on the value axis of this curve point (this is the \a mainValue)
+  
+  The container for storing multiple data points is \ref QCPCurveDataContainer. It is a typedef for
+  \ref QCPDataContainer with \ref QCPCurveData as the DataType template parameter. See the
+  documentation there for an explanation regarding the data type's generic methods.
+  
+  \see QCPCurveDataContainer
+*/
+
+/* start documentation of inline functions */
+
+/*! \fn double QCPCurveData::sortKey() const
+  
+  Returns the \a t member of this data point.
+  
+  For a general explanation of what this method is good for in the context of the data container,
+  see the documentation of \ref QCPDataContainer.
+*/
+
+/*! \fn static QCPCurveData QCPCurveData::fromSortKey(double sortKey)
+  
+  Returns a data point with the specified \a sortKey (assigned to the data point's \a t member).
+  All other members are set to zero.
+  
+  For a general explanation of what this method is good for in the context of the data container,
+  see the documentation of \ref QCPDataContainer.
+*/
+
+/*! \fn static static bool QCPCurveData::sortKeyIsMainKey()
+  
   Since the member \a key is the data point key coordinate and the member \a t is the data ordering
   parameter, this method returns false.
   
@@ -25830,6 +26870,13 @@ QVector<QLineF> QCPStatisticalBox::getWhiskerBarLines(QCPStatisticalBoxDataConta
 
 /* start of documentation of inline functions */
 
+/*! \fn int QCPColorMapData::valueRowOffset() const
+  
+  Returns the storage row that holds value index 0. The rows form a ring that \ref appendValueRow
+  advances by one; \ref setSize resets the offset to zero. The cell accessors take care of the
+  offset, so this is only of interest to code that reads the raw storage.
+*/
+
 /*! \fn bool QCPColorMapData::isEmpty() const
   
   Returns whether this instance carries no data. This is equivalent to having a size where at least
@@ -25853,7 +26900,11 @@ QCPColorMapData::QCPColorMapData(int keySize, int valueSize, const QCPRange &key
   mIsEmpty(true),
   mData(nullptr),
   mAlpha(nullptr),
-  mDataModified(true)
+  mDataModified(true),
+  mValueRowOffset(0),
+  mDirtyRowCount(0),
+  mDirtyKeyLower(0),
+  mDirtyKeyUpper(-1)
 {
   setSize(keySize, valueSize);
   fill(0);
@@ -25874,7 +26925,11 @@ QCPColorMapData::QCPColorMapData(const QCPColorMapData &other) :
   mIsEmpty(true),
   mData(nullptr),
   mAlpha(nullptr),
-  mDataModified(true)
+  mDataModified(true),
+  mValueRowOffset(0),
+  mDirtyRowCount(0),
+  mDirtyKeyLower(0),
+  mDirtyKeyUpper(-1)
 {
   *this = other;
 }
@@ -25902,6 +26957,7 @@ QCPColorMapData &QCPColorMapData::operator=(const QCPColorMapData &other)
         memcpy(mAlpha, other.mAlpha, sizeof(mAlpha[0])*size_t(keySize*valueSize));
     }
     mDataBounds = other.mDataBounds;
+    mValueRowOffset = other.mValueRowOffset;
     mDataModified = true;
   }
   return *this;
@@ -25913,7 +26969,7 @@ double QCPColorMapData::data(double key, double value)
   int keyCell = int( (key-mKeyRange.lower)/(mKeyRange.upper-mKeyRange.lower)*(mKeySize-1)+0.5 );
   int valueCell = int( (value-mValueRange.lower)/(mValueRange.upper-mValueRange.lower)*(mValueSize-1)+0.5 );
   if (keyCell >= 0 && keyCell < mKeySize && valueCell >= 0 && valueCell < mValueSize)
-    return mData[valueCell*mKeySize + keyCell];
+    return mData[valueRow(valueCell)*mKeySize + keyCell];
   else
     return 0;
 }
@@ -25922,7 +26978,7 @@ double QCPColorMapData::data(double key, double value)
 double QCPColorMapData::cell(int keyIndex, int valueIndex)
 {
   if (keyIndex >= 0 && keyIndex < mKeySize && valueIndex >= 0 && valueIndex < mValueSize)
-    return mData[valueIndex*mKeySize + keyIndex];
+    return mData[valueRow(valueIndex)*mKeySize + keyIndex];
   else
     return 0;
 }
@@ -25938,7 +26994,7 @@ double QCPColorMapData::cell(int keyIndex, int valueIndex)
 unsigned char QCPColorMapData::alpha(int keyIndex, int valueIndex)
 {
   if (mAlpha && keyIndex >= 0 && keyIndex < mKeySize && valueIndex >= 0 && valueIndex < mValueSize)
-    return mAlpha[valueIndex*mKeySize + keyIndex];
+    return mAlpha[valueRow(valueIndex)*mKeySize + keyIndex];
   else
     return 255;
 }
@@ -25982,6 +27038,8 @@ void QCPColorMapData::setSize(int keySize, int valueSize)
     if (mAlpha) // if we had an alpha map, recreate it with new size
       createAlpha();
     
+    mValueRowOffset = 0;
+    clearDirty();
     mDataModified = true;
   }
 }
@@ -26080,12 +27138,13 @@ void QCPColorMapData::setData(double key, double value, double z)
   int valueCell = int( (value-mValueRange.lower)/(mValueRange.upper-mValueRange.lower)*(mValueSize-1)+0.5 );
   if (keyCell >= 0 && keyCell < mKeySize && valueCell >= 0 && valueCell < mValueSize)
   {
-    mData[valueCell*mKeySize + keyCell] = z;
+    const int row = valueRow(valueCell);
+    mData[row*mKeySize + keyCell] = z;
     if (z < mDataBounds.lower)
       mDataBounds.lower = z;
     if (z > mDataBounds.upper)
       mDataBounds.upper = z;
-     mDataModified = true;
+    markDirty(row, keyCell, keyCell);
   }
 }
 
@@ -26104,12 +27163,13 @@ void QCPColorMapData::setCell(int keyIndex, int valueIndex, double z)
 {
   if (keyIndex >= 0 && keyIndex < mKeySize && valueIndex >= 0 && valueIndex < mValueSize)
   {
-    mData[valueIndex*mKeySize + keyIndex] = z;
+    const int row = valueRow(valueIndex);
+    mData[row*mKeySize + keyIndex] = z;
     if (z < mDataBounds.lower)
       mDataBounds.lower = z;
     if (z > mDataBounds.upper)
       mDataBounds.upper = z;
-     mDataModified = true;
+    markDirty(row, keyIndex, keyIndex);
   } else
     qDebug() << Q_FUNC_INFO << "index out of bounds:" << keyIndex << valueIndex;
 }
@@ -26135,8 +27195,9 @@ void QCPColorMapData::setAlpha(int keyIndex, int valueIndex, unsigned char alpha
   {
     if (mAlpha || createAlpha())
     {
-      mAlpha[valueIndex*mKeySize + keyIndex] = alpha;
-      mDataModified = true;
+      const int row = valueRow(valueIndex);
+      mAlpha[row*mKeySize + keyIndex] = alpha;
+      markDirty(row, keyIndex, keyIndex);
     }
   } else
     qDebug() << Q_FUNC_INFO << "index out of bounds:" << keyIndex << valueIndex;
@@ -26227,6 +27288,76 @@ void QCPColorMapData::fillAlpha(unsigned char alpha)
   }
 }
 
+/*! \internal
+  
+  Records that cells \a keyLower to \a keyUpper of storage row \a row have changed, so the next
+  \ref QCPColorMap::updateMapImage only has to colorize changed rows over the union of the changed
+  key spans. Changes that touch the whole map set \a mDataModified instead.
+*/
+void QCPColorMapData::markDirty(int row, int keyLower, int keyUpper)
+{
+  if (mDirtyRows.size() != mValueSize)
+    mDirtyRows.fill(false, mValueSize);
+  if (!mDirtyRows.at(row))
+  {
+    mDirtyRows[row] = true;
+    ++mDirtyRowCount;
+  }
+  if (mDirtyKeyLower > mDirtyKeyUpper)
+  {
+    mDirtyKeyLower = keyLower;
+    mDirtyKeyUpper = keyUpper;
+  } else
+  {
+    mDirtyKeyLower = qMin(mDirtyKeyLower, keyLower);
+    mDirtyKeyUpper = qMax(mDirtyKeyUpper, keyUpper);
+  }
+}
+
+/*! \internal
+  
+  Forgets all changes recorded with \ref markDirty, called once the map image reflects them.
+*/
+void QCPColorMapData::clearDirty()
+{
+  if (mDirtyRowCount > 0)
+    mDirtyRows.fill(false, mValueSize);
+  mDirtyRowCount = 0;
+  mDirtyKeyLower = 0;
+  mDirtyKeyUpper = -1;
+}
+
+/*!
+  Shifts all cells down by one value index, discarding the row at value index 0, and sets the row
+  at value index valueSize-1 to the \a keySize values pointed to by \a keyData. If an alpha map
+  exists, the new row is fully opaque.
+
+  The rows are stored as a ring, so this costs O(keySize) regardless of the value size, and like
+  any other cell change (see \ref setCell) only the new row is colorized on the next replot. This makes
+  the method suitable for scrolling displays such as spectrogram waterfalls, where every new
+  spectrum enters at the top and the oldest one leaves at the bottom.
+
+  \see setCell, valueRowOffset
+*/
+void QCPColorMapData::appendValueRow(const double *keyData)
+{
+  if (mIsEmpty || !mData)
+    return;
+  const int row = mValueRowOffset; // storage row of the oldest value index, which the new row replaces
+  memcpy(mData+size_t(row)*size_t(mKeySize), keyData, sizeof(mData[0])*size_t(mKeySize));
+  if (mAlpha)
+    memset(mAlpha+size_t(row)*size_t(mKeySize), 255, sizeof(mAlpha[0])*size_t(mKeySize));
+  for (int i=0; i<mKeySize; ++i)
+  {
+    if (keyData[i] < mDataBounds.lower)
+      mDataBounds.lower = keyData[i];
+    if (keyData[i] > mDataBounds.upper)
+      mDataBounds.upper = keyData[i];
+  }
+  mValueRowOffset = row+1 < mValueSize ? row+1 : 0;
+  markDirty(row, 0, mKeySize-1);
+}
+
 /*!
   Transforms plot coordinates given by \a key and \a value to cell indices of this QCPColorMapData
   instance. The resulting cell indices are returned via the output parameters \a keyIndex and \a
@@ -26657,7 +27788,16 @@ void QCPColorMap::updateLegendIcon(Qt::TransformationMode transformMode, const Q
   {
     bool mirrorX = (keyAxis()->orientation() == Qt::Horizontal ? keyAxis() : valueAxis())->rangeReversed();
     bool mirrorY = (valueAxis()->orientation() == Qt::Vertical ? valueAxis() : keyAxis())->rangeReversed();
-    mLegendIcon = QPixmap::fromImage(mMapImage.mirrored(mirrorX, mirrorY)).scaled(thumbSize, Qt::KeepAspectRatio, transformMode);
+    if (mMapData->mValueRowOffset == 0)
+      mLegendIcon = QPixmap::fromImage(mMapImage.mirrored(mirrorX, mirrorY)).scaled(thumbSize, Qt::KeepAspectRatio, transformMode);
+    else
+    {
+      QImage ordered(mMapImage.size(), mMapImage.format()); // value rows back in index order, see drawMapImage
+      QPainter painter(&ordered);
+      drawMapImage(&painter, QRectF(ordered.rect()), mirrorX, mirrorY);
+      painter.end();
+      mLegendIcon = QPixmap::fromImage(ordered).scaled(thumbSize, Qt::KeepAspectRatio, transformMode);
+    }
   }
 }
 
@@ -26746,6 +27886,12 @@ QCPRange QCPColorMap::getValueRange(bool &foundRange, QCP::SignDomain inSignDoma
   has been invalidated for a different reason (e.g. a change of the data range with \ref
   setDataRange).
   
+  The image holds the value rows in storage order (see \ref QCPColorMapData::valueRowOffset). If
+  only individual cells or rows changed since the last update (\ref QCPColorMapData::setCell, \ref
+  QCPColorMapData::setData, \ref QCPColorMapData::setAlpha, \ref
+  QCPColorMapData::appendValueRow), just the affected rows are colorized, over the changed key
+  span. Anything that touches the whole map, or an oversampled image, recolorizes everything.
+  
   If the map cell count is low, the image created will be oversampled in order to avoid a
   QPainter::drawImage bug which makes inner pixel boundaries jitter when stretch-drawing images
   without smooth transform enabled. Accordingly, oversampling isn't performed if \ref
@@ -26763,6 +27909,45 @@ void QCPColorMap::updateMapImage()
   int keyOversamplingFactor = mInterpolate ? 1 : int(1.0+100.0/double(keySize)); // make mMapImage have at least size 100, factor becomes 1 if size > 200 or interpolation is on
   int valueOversamplingFactor = mInterpolate ? 1 : int(1.0+100.0/double(valueSize)); // make mMapImage have at least size 100, factor becomes 1 if size > 200 or interpolation is on
   
+  // if only some cells changed since the last update (see QCPColorMapData::markDirty), colorize just
+  // their rows, over the changed key span:
+  const QSize imageSize = keyAxis->orientation() == Qt::Horizontal ? QSize(keySize, valueSize) : QSize(valueSize, keySize);
+  if (!mMapData->mDataModified && !mMapImageInvalidated && mMapData->mDirtyRowCount > 0 &&
+      keyOversamplingFactor == 1 && valueOversamplingFactor == 1 && mMapImage.size() == imageSize)
+  {
+    const double *rawData = mMapData->mData;
+    const unsigned char *rawAlpha = mMapData->mAlpha;
+    const bool logarithmic = mDataScaleType==QCPAxis::stLogarithmic;
+    const int keyLower = mMapData->mDirtyKeyLower;
+    const int keyUpper = mMapData->mDirtyKeyUpper;
+    for (int row=0; row<valueSize; ++row)
+    {
+      if (!mMapData->mDirtyRows.at(row))
+        continue;
+      const int offset = row*keySize+keyLower;
+      if (keyAxis->orientation() == Qt::Horizontal)
+      {
+        QRgb* pixels = reinterpret_cast<QRgb*>(mMapImage.scanLine(valueSize-1-row))+keyLower;
+        if (rawAlpha)
+          mGradient.colorize(rawData+offset, rawAlpha+offset, mDataRange, pixels, keyUpper-keyLower+1, 1, logarithmic);
+        else
+          mGradient.colorize(rawData+offset, mDataRange, pixels, keyUpper-keyLower+1, 1, logarithmic);
+      } else // keyAxis->orientation() == Qt::Vertical, the row is one pixel in each scanline
+      {
+        for (int line=keyLower; line<=keyUpper; ++line)
+        {
+          QRgb* pixels = reinterpret_cast<QRgb*>(mMapImage.scanLine(keySize-1-line))+row;
+          if (rawAlpha)
+            mGradient.colorize(rawData+row*keySize+line, rawAlpha+row*keySize+line, mDataRange, pixels, 1, keySize, logarithmic);
+          else
+            mGradient.colorize(rawData+row*keySize+line, mDataRange, pixels, 1, keySize, logarithmic);
+        }
+      }
+    }
+    mMapData->clearDirty();
+    return;
+  }
+  
   // resize mMapImage to correct dimensions including possible oversampling factors, according to key/value axes orientation:
   if (keyAxis->orientation() == Qt::Horizontal && (mMapImage.width() != keySize*keyOversamplingFactor || mMapImage.height() != valueSize*valueOversamplingFactor))
     mMapImage = QImage(QSize(keySize*keyOversamplingFactor, valueSize*valueOversamplingFactor), format);
@@ -26825,6 +28010,7 @@ void QCPColorMap::updateMapImage()
     }
   }
   mMapData->mDataModified = false;
+  mMapData->clearDirty();
   mMapImageInvalidated = false;
 }
 
@@ -26835,7 +28021,7 @@ void QCPColorMap::draw(QCPPainter *painter)
   if (!mKeyAxis || !mValueAxis) return;
   applyDefaultAntialiasingHint(painter);
   
-  if (mMapData->mDataModified || mMapImageInvalidated)
+  if (mMapData->mDataModified || mMapImageInvalidated || mMapData->mDirtyRowCount > 0)
     updateMapImage();
   
   // use buffer if painting vectorized (PDF):
@@ -26885,7 +28071,7 @@ void QCPColorMap::draw(QCPPainter *painter)
                                   coordsToPixels(mMapData->keyRange().upper, mMapData->valueRange().upper)).normalized();
     localPainter->setClipRect(tightClipRect, Qt::IntersectClip);
   }
-  localPainter->drawImage(imageRect, mMapImage.mirrored(mirrorX, mirrorY));
+  drawMapImage(localPainter, imageRect, mirrorX, mirrorY);
   if (mTightBoundary)
     localPainter->setClipRegion(clipBackup);
   localPainter->setRenderHint(QPainter::SmoothPixmapTransform, smoothBackup);
@@ -26897,6 +28083,41 @@ void QCPColorMap::draw(QCPPainter *painter)
   }
 }
 
+/*! \internal
+  
+  Draws the map image into \a targetRect, mirrored as given by \a mirrorX and \a mirrorY. Since
+  the image rows follow the storage order of the value rows, which is rotated by \ref
+  QCPColorMapData::valueRowOffset, the image is drawn as two slices along the value direction
+  that put value index 0 back at the lower end of the value range.
+*/
+void QCPColorMap::drawMapImage(QPainter *painter, const QRectF &targetRect, bool mirrorX, bool mirrorY) const
+{
+  const QImage image = mMapImage.mirrored(mirrorX, mirrorY);
+  const int valueSize = mMapData->valueSize();
+  if (mMapData->mValueRowOffset == 0 || valueSize < 1)
+  {
+    painter->drawImage(targetRect, image);
+    return;
+  }
+  const bool valueVertical = keyAxis()->orientation() == Qt::Horizontal; // value rows are image scanlines
+  const int length = valueVertical ? image.height() : image.width();
+  const int shift = mMapData->mValueRowOffset*(length/valueSize); // offset in image pixels, including oversampling
+  // first image pixel (along the value direction) that is drawn at the start of targetRect:
+  const int split = valueVertical != (valueVertical ? mirrorY : mirrorX) ? length-shift : shift;
+  const double fraction = double(length-split)/double(length);
+  if (valueVertical)
+  {
+    const double h = targetRect.height()*fraction;
+    painter->drawImage(QRectF(targetRect.left(), targetRect.top(), targetRect.width(), h), image, QRectF(0, split, image.width(), length-split));
+    painter->drawImage(QRectF(targetRect.left(), targetRect.top()+h, targetRect.width(), targetRect.height()-h), image, QRectF(0, 0, image.width(), split));
+  } else
+  {
+    const double w = targetRect.width()*fraction;
+    painter->drawImage(QRectF(targetRect.left(), targetRect.top(), w, targetRect.height()), image, QRectF(split, 0, length-split, image.height()));
+    painter->drawImage(QRectF(targetRect.left()+w, targetRect.top(), targetRect.width()-w, targetRect.height()), image, QRectF(0, 0, split, image.height()));
+  }
+}
+
 /* inherits documentation from base class */
 void QCPColorMap::drawLegendIcon(QCPPainter *painter, const QRectF &rect) const
 {
@@ -113,6 +113,7 @@ class QCPAxisRect;
 class QCPAxisPainterPrivate;
 class QCPAbstractPlottable;
 class QCPGraph;
+class QCPSampleGraph;
 class QCPAbstractItem;
 class QCPPlottableInterface1D;
 class QCPLegend;
@@ -2622,9 +2623,11 @@ public:
   int size() const { return mData.size()-mPreallocSize; }
   bool isEmpty() const { return size() == 0; }
   bool autoSqueeze() const { return mAutoSqueeze; }
+  int ringCapacity() const { return mRingCapacity; }
   
   // setters:
   void setAutoSqueeze(bool enabled);
+  void setRingCapacity(int capacity);
   
   // non-virtual methods:
   void set(const QCPDataContainer<DataType> &data);
@@ -2655,6 +2658,7 @@ public:
 protected:
   // property members:
   bool mAutoSqueeze;
+  int mRingCapacity;
   
   // non-property memebers:
   QVector<DataType> mData;
@@ -2664,6 +2668,8 @@ protected:
   // non-virtual methods:
   void preallocateGrow(int minimumPreallocSize);
   void performAutoSqueeze();
+  void ringMakeRoom(int appendCount);
+  void ringExpire();
 };
 
 
@@ -2689,6 +2695,10 @@ protected:
   specifying that added data is already itself sorted by key, if he can guarantee that this is the
   case (see for example \ref add(const QVector<DataType> &data, bool alreadySorted)).
 
+  For streaming data with increasing keys, e.g. a rolling oscilloscope view, the container can be
+  limited to a fixed number of points with \ref setRingCapacity. It then expires the oldest points
+  as new ones are appended, and appending never reallocates.
+
   The data can be accessed with the provided const iterators (\ref constBegin, \ref constEnd). If
   it is necessary to alter existing data in-place, the non-const iterators can be used (\ref begin,
   \ref end). Changing data members that are not the sort key (for most data types called \a key) is
@@ -2752,6 +2762,13 @@ protected:
   Returns whether this container holds no data points.
 */
 
+/*! \fn int QCPDataContainer<DataType>::ringCapacity() const
+  
+  Returns the maximum number of data points the container keeps, or 0 if it is unlimited.
+  
+  \see setRingCapacity
+*/
+
 /*! \fn QCPDataContainer::const_iterator QCPDataContainer<DataType>::constBegin() const
   
   Returns a const iterator to the first data point in this container.
@@ -2805,6 +2822,7 @@ protected:
 template <class DataType>
 QCPDataContainer<DataType>::QCPDataContainer() :
   mAutoSqueeze(true),
+  mRingCapacity(0),
   mPreallocSize(0),
   mPreallocIteration(0)
 {
@@ -2829,6 +2847,41 @@ void QCPDataContainer<DataType>::setAutoSqueeze(bool enabled)
   }
 }
 
+/*!
+  Limits the container to the newest \a capacity data points, or removes the limit if \a capacity
+  is 0.
+  
+  With a limit, the container works like a ring buffer for data with increasing keys, as in a
+  rolling oscilloscope view. Each \ref add expires the points with the smallest keys beyond the
+  limit. Storage for twice the capacity is allocated once. The points always occupy a contiguous
+  window of it, which moves forward as points are appended and expired. When the window reaches the
+  end, the points are moved back to the front, once every \a capacity appends. Appending therefore
+  costs amortized O(1) and never reallocates, and the iterators stay plain pointers into
+  contiguous memory, so plottables use the container as before.
+  
+  Setting a capacity keeps the newest points that fit. While a capacity is set, auto squeeze (\ref
+  setAutoSqueeze) is suspended and \ref squeeze keeps the storage. Inserting points between
+  existing keys or before the first one still works, but may reallocate like in an unlimited
+  container.
+*/
+template <class DataType>
+void QCPDataContainer<DataType>::setRingCapacity(int capacity)
+{
+  mRingCapacity = qMax(0, capacity);
+  if (mRingCapacity > 0)
+  {
+    const int keptCount = qMin(size(), mRingCapacity);
+    QVector<DataType> storage;
+    storage.reserve(2*mRingCapacity);
+    storage.resize(keptCount);
+    std::copy(constEnd()-keptCount, constEnd(), storage.begin());
+    mData.swap(storage);
+    mPreallocSize = 0;
+    mPreallocIteration = 0;
+  } else if (mAutoSqueeze)
+    performAutoSqueeze();
+}
+
 /*! \overload
   
   Replaces the current data in this container with the provided \a data.
@@ -2854,6 +2907,18 @@ void QCPDataContainer<DataType>::set(const QCPDataContainer<DataType> &data)
 template <class DataType>
 void QCPDataContainer<DataType>::set(const QVector<DataType> &data, bool alreadySorted)
 {
+  if (mRingCapacity > 0) // copy the newest points that fit into the ring storage, instead of adopting the storage of data
+  {
+    QVector<DataType> sorted = data;
+    if (!alreadySorted)
+      std::sort(sorted.begin(), sorted.end(), qcpLessThanSortKey<DataType>);
+    const int n = qMin(sorted.size(), mRingCapacity);
+    mData.resize(n);
+    mPreallocSize = 0;
+    mPreallocIteration = 0;
+    std::copy(sorted.constEnd()-n, sorted.constEnd(), mData.begin());
+    return;
+  }
   mData = data;
   mPreallocSize = 0;
   mPreallocIteration = 0;
@@ -2884,11 +2949,15 @@ void QCPDataContainer<DataType>::add(const QCPDataContainer<DataType> &data)
     std::copy(data.constBegin(), data.constEnd(), begin());
   } else // don't need to prepend, so append and merge if necessary
   {
+    if (mRingCapacity > 0)
+      ringMakeRoom(n);
     mData.resize(mData.size()+n);
     std::copy(data.constBegin(), data.constEnd(), end()-n);
     if (oldSize > 0 && !qcpLessThanSortKey<DataType>(*(constEnd()-n-1), *(constEnd()-n))) // if appended range keys aren't all greater than existing ones, merge the two partitions
       std::inplace_merge(begin(), end()-n, end(), qcpLessThanSortKey<DataType>);
   }
+  if (mRingCapacity > 0)
+    ringExpire();
 }
 
 /*!
@@ -2921,6 +2990,8 @@ void QCPDataContainer<DataType>::add(const QVector<DataType> &data, bool already
     std::copy(data.constBegin(), data.constEnd(), begin());
   } else // don't need to prepend, so append and then sort and merge if necessary
   {
+    if (mRingCapacity > 0)
+      ringMakeRoom(n);
     mData.resize(mData.size()+n);
     std::copy(data.constBegin(), data.constEnd(), end()-n);
     if (!alreadySorted) // sort appended subrange if it wasn't already sorted
@@ -2928,6 +2999,8 @@ void QCPDataContainer<DataType>::add(const QVector<DataType> &data, bool already
     if (oldSize > 0 && !qcpLessThanSortKey<DataType>(*(constEnd()-n-1), *(constEnd()-n))) // if appended range keys aren't all greater than existing ones, merge the two partitions
       std::inplace_merge(begin(), end()-n, end(), qcpLessThanSortKey<DataType>);
   }
+  if (mRingCapacity > 0)
+    ringExpire();
 }
 
 /*! \overload
@@ -2941,6 +3014,8 @@ void QCPDataContainer<DataType>::add(const DataType &data)
 {
   if (isEmpty() || !qcpLessThanSortKey<DataType>(data, *(constEnd()-1))) // quickly handle appends if new data key is greater or equal to existing ones
   {
+    if (mRingCapacity > 0)
+      ringMakeRoom(1);
     mData.append(data);
   } else if (qcpLessThanSortKey<DataType>(data, *constBegin()))  // quickly handle prepends using preallocated space
   {
@@ -2953,6 +3028,8 @@ void QCPDataContainer<DataType>::add(const DataType &data)
     QCPDataContainer<DataType>::iterator insertionPoint = std::lower_bound(begin(), end(), data, qcpLessThanSortKey<DataType>);
     mData.insert(insertionPoint, data);
   }
+  if (mRingCapacity > 0)
+    ringExpire();
 }
 
 /*!
@@ -3082,7 +3159,7 @@ void QCPDataContainer<DataType>::squeeze(bool preAllocation, bool postAllocation
     }
     mPreallocIteration = 0;
   }
-  if (postAllocation)
+  if (postAllocation && mRingCapacity == 0) // a ring container keeps its storage
     mData.squeeze();
 }
 
@@ -3419,6 +3496,8 @@ void QCPDataContainer<DataType>::preallocateGrow(int minimumPreallocSize)
 template <class DataType>
 void QCPDataContainer<DataType>::performAutoSqueeze()
 {
+  if (mRingCapacity > 0) // the ring storage is sized once by setRingCapacity
+    return;
   const int totalAlloc = mData.capacity();
   const int postAllocSize = totalAlloc-mData.size();
   const int usedSize = size();
@@ -3439,6 +3518,38 @@ void QCPDataContainer<DataType>::performAutoSqueeze()
 }
 
 
+/*! \internal
+  
+  Prepares a ring container (see \ref setRingCapacity) for appending \a appendCount points. If the
+  storage has no room left behind the data, the points are moved back to its front, in place, so
+  the append doesn't reallocate as long as \a appendCount doesn't exceed the capacity. Nothing is
+  expired here: the appended points may merge in between existing ones, so \ref ringExpire trims
+  to the largest keys only after the merge.
+*/
+template <class DataType>
+void QCPDataContainer<DataType>::ringMakeRoom(int appendCount)
+{
+  if (mData.size()+appendCount > mData.capacity() && mPreallocSize > 0)
+  {
+    std::copy(begin(), end(), mData.begin());
+    mData.resize(size());
+    mPreallocSize = 0;
+    mPreallocIteration = 0;
+  }
+}
+
+/*! \internal
+  
+  Expires the points with the smallest keys beyond the capacity of a ring container (see \ref
+  setRingCapacity), by moving the start of the data window past them.
+*/
+template <class DataType>
+void QCPDataContainer<DataType>::ringExpire()
+{
+  if (size() > mRingCapacity)
+    mPreallocSize += size()-mRingCapacity;
+}
+
 /* end of 'src/datacontainer.h' */
 
 
@@ -4841,6 +4952,7 @@ protected:
   // non-virtual methods:
   bool stopsUseAlpha() const;
   void updateColorBuffer();
+  QRgb nanRgb() const;
 };
 Q_DECLARE_METATYPE(QCPColorGradient::ColorInterpolation)
 Q_DECLARE_METATYPE(QCPColorGradient::NanHandling)
@@ -5491,6 +5603,24 @@ Q_DECLARE_TYPEINFO(QCPGraphData, Q_PRIMITIVE_TYPE);
 */
 typedef QCPDataContainer<QCPGraphData> QCPGraphDataContainer;
 
+class QCP_LIB_DECL QCPGraphDataPyramid
+{
+public:
+  QCPGraphDataPyramid();
+  
+  // non-property methods:
+  void update(const QCPGraphDataContainer *data);
+  void clear();
+  QCPRange valueBounds(int beginIndex, int endIndex) const;
+  
+protected:
+  // non-property members:
+  const QCPGraphDataContainer *mData;
+  int mCoveredCount; // data points the levels were last updated for
+  double mFirstKey, mLastKey; // keys at index 0 and mCoveredCount-1 back then, to tell appends from other changes
+  QVector<QVector<QCPRange> > mLevels; // mLevels[l][i] bounds the values of block i of (16 << l) points
+};
+
 class QCP_LIB_DECL QCPGraph : public QCPAbstractPlottable1D<QCPGraphData>
 {
   Q_OBJECT
@@ -5500,6 +5630,8 @@ class QCP_LIB_DECL QCPGraph : public QCPAbstractPlottable1D<QCPGraphData>
   Q_PROPERTY(int scatterSkip READ scatterSkip WRITE setScatterSkip)
   Q_PROPERTY(QCPGraph* channelFillGraph READ channelFillGraph WRITE setChannelFillGraph)
   Q_PROPERTY(bool adaptiveSampling READ adaptiveSampling WRITE setAdaptiveSampling)
+  Q_PROPERTY(bool decimationPyramid READ decimationPyramid WRITE setDecimationPyramid)
+  Q_PROPERTY(bool parallelSampling READ parallelSampling WRITE setParallelSampling)
   /// \endcond
 public:
   /*!
@@ -5527,6 +5659,8 @@ public:
   int scatterSkip() const { return mScatterSkip; }
   QCPGraph *channelFillGraph() const { return mChannelFillGraph.data(); }
   bool adaptiveSampling() const { return mAdaptiveSampling; }
+  bool decimationPyramid() const { return mDecimationPyramid; }
+  bool parallelSampling() const { return mParallelSampling; }
   
   // setters:
   void setData(QSharedPointer<QCPGraphDataContainer> data);
@@ -5536,10 +5670,13 @@ public:
   void setScatterSkip(int skip);
   void setChannelFillGraph(QCPGraph *targetGraph);
   void setAdaptiveSampling(bool enabled);
+  void setDecimationPyramid(bool enabled);
+  void setParallelSampling(bool enabled);
   
   // non-property methods:
   void addData(const QVector<double> &keys, const QVector<double> &values, bool alreadySorted=false);
   void addData(double key, double value);
+  void invalidateDecimationPyramid();
   
   // reimplemented virtual methods:
   virtual double selectTest(const QPointF &pos, bool onlySelectable, QVariant *details=nullptr) const Q_DECL_OVERRIDE;
@@ -5553,6 +5690,11 @@ protected:
   int mScatterSkip;
   QPointer<QCPGraph> mChannelFillGraph;
   bool mAdaptiveSampling;
+  bool mDecimationPyramid;
+  bool mParallelSampling;
+  
+  // non-property members:
+  mutable QCPGraphDataPyramid mPyramid;
   
   // reimplemented virtual methods:
   virtual void draw(QCPPainter *painter) Q_DECL_OVERRIDE;
@@ -5569,6 +5711,8 @@ protected:
   
   // non-virtual methods:
   void getVisibleDataBounds(QCPGraphDataContainer::const_iterator &begin, QCPGraphDataContainer::const_iterator &end, const QCPDataRange &rangeRestriction) const;
+  void getPyramidLineData(QVector<QCPGraphData> *lineData, const QCPGraphDataContainer::const_iterator &begin, const QCPGraphDataContainer::const_iterator &end) const;
+  void getAdaptiveLineChunk(QVector<QCPGraphData> *lineData, QCPGraphDataContainer::const_iterator begin, QCPGraphDataContainer::const_iterator end, QCPGraphDataContainer::const_iterator dataEnd, double lastIntervalEndKey, double keyEpsilon) const;
   void getLines(QVector<QPointF> *lines, const QCPDataRange &dataRange) const;
   void getScatters(QVector<QPointF> *scatters, const QCPDataRange &dataRange) const;
   QVector<QPointF> dataToLines(const QVector<QCPGraphData> &data) const;
@@ -5593,6 +5737,58 @@ protected:
 };
 Q_DECLARE_METATYPE(QCPGraph::LineStyle)
 
+
+class QCP_LIB_DECL QCPSampleGraph : public QCPAbstractPlottable
+{
+  Q_OBJECT
+public:
+  explicit QCPSampleGraph(QCPAxis *keyAxis, QCPAxis *valueAxis);
+  virtual ~QCPSampleGraph() Q_DECL_OVERRIDE;
+  
+  // getters:
+  const float *samples() const { return mSamples; }
+  int sampleCount() const { return mSampleCount; }
+  double keyStep() const { return mKeyStep; }
+  double firstKey() const { return mFirstKey; }
+  
+  // setters:
+  void setSamples(const float *samples, int count, double keyStep=1.0, double firstKey=0.0);
+  void setData(const QVector<float> &values, double keyStep=1.0, double firstKey=0.0);
+  
+  // non-property methods:
+  void addData(const float *values, int count);
+  double sampleKey(int index) const { return mFirstKey+index*mKeyStep; }
+  
+  // reimplemented virtual methods:
+  virtual double selectTest(const QPointF &pos, bool onlySelectable, QVariant *details=nullptr) const Q_DECL_OVERRIDE;
+  virtual QCPRange getKeyRange(bool &foundRange, QCP::SignDomain inSignDomain=QCP::sdBoth) const Q_DECL_OVERRIDE;
+  virtual QCPRange getValueRange(bool &foundRange, QCP::SignDomain inSignDomain=QCP::sdBoth, const QCPRange &inKeyRange=QCPRange()) const Q_DECL_OVERRIDE;
+  
+protected:
+  // property members:
+  const float *mSamples;
+  int mSampleCount;
+  double mKeyStep;
+  double mFirstKey;
+  
+  // non-property members:
+  QVector<float> mOwnedSamples;
+  
+  // reimplemented virtual methods:
+  virtual void draw(QCPPainter *painter) Q_DECL_OVERRIDE;
+  virtual void drawLegendIcon(QCPPainter *painter, const QRectF &rect) const Q_DECL_OVERRIDE;
+  
+  // non-virtual methods:
+  int sampleIndexAbove(double key, bool inclusive) const;
+  void getVisibleIndexRange(int &begin, int &end) const;
+  void getLines(QVector<QPointF> *lines) const;
+  void getAffineLines(QVector<QPointF> *lines, int begin, int end) const;
+  void getMappedLines(QVector<QPointF> *lines, int begin, int end) const;
+  
+  friend class QCustomPlot;
+  friend class QCPLegend;
+};
+
 /* end of 'src/plottables/plottable-graph.h' */
 
 
@@ -6033,6 +6229,7 @@ public:
   QCPRange keyRange() const { return mKeyRange; }
   QCPRange valueRange() const { return mValueRange; }
   QCPRange dataBounds() const { return mDataBounds; }
+  int valueRowOffset() const { return mValueRowOffset; }
   double data(double key, double value);
   double cell(int keyIndex, int valueIndex);
   unsigned char alpha(int keyIndex, int valueIndex);
@@ -6054,6 +6251,7 @@ public:
   void clearAlpha();
   void fill(double z);
   void fillAlpha(unsigned char alpha);
+  void appendValueRow(const double *keyData);
   bool isEmpty() const { return mIsEmpty; }
   void coordToCell(double key, double value, int *keyIndex, int *valueIndex) const;
   void cellToCoord(int keyIndex, int valueIndex, double *key, double *value) const;
@@ -6069,8 +6267,15 @@ protected:
   unsigned char *mAlpha;
   QCPRange mDataBounds;
   bool mDataModified;
+  int mValueRowOffset; // storage row of value index 0, rows form a ring (see appendValueRow)
+  QVector<bool> mDirtyRows; // storage rows changed since the map image was last updated
+  int mDirtyRowCount;
+  int mDirtyKeyLower, mDirtyKeyUpper; // key index span of the changes in those rows
   
   bool createAlpha(bool initializeOpaque=true);
+  void markDirty(int row, int keyLower, int keyUpper);
+  void clearDirty();
+  int valueRow(int valueIndex) const { const int row = valueIndex+mValueRowOffset; return row < mValueSize ? row : row-mValueSize; }
   
   friend class QCPColorMap;
 };
@@ -6145,6 +6350,9 @@ protected:
   virtual void draw(QCPPainter *painter) Q_DECL_OVERRIDE;
   virtual void drawLegendIcon(QCPPainter *painter, const QRectF &rect) const Q_DECL_OVERRIDE;
   
+  // non-virtual methods:
+  void drawMapImage(QPainter *painter, const QRectF &targetRect, bool mirrorX, bool mirrorY) const;
+  
   friend class QCustomPlot;
   friend class QCPLegend;
 };
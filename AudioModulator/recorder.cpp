@@ -0,0 +1,63 @@
+#include "recorder.h"
+#include <chrono>
+
+WavRecorder::WavRecorder(size_t capacity, int flush_ms)
+    : ring(capacity), batch(ring.capacity()), flush_ms(flush_ms) {}
+
+WavRecorder::~WavRecorder() {
+    stop();
+}
+
+bool WavRecorder::start(const char* path, int samplerate) {
+    if (file) return false;
+    SF_INFO info = {0};
+    info.channels = 1;
+    info.samplerate = samplerate;
+    info.format = SF_FORMAT_WAV | SF_FORMAT_FLOAT;
+    file = sf_open(path, SFM_WRITE, &info);
+    if (!file) return false;
+    // Samples pushed after the previous stop() belong to no recording.
+    while (ring.pop(batch.data(), batch.size()) > 0) {}
+    dropped.store(0, std::memory_order_relaxed);
+    stopping = false;
+    writer = std::thread(&WavRecorder::run, this);
+    recording.store(true, std::memory_order_release);
+    return true;
+}
+
+void WavRecorder::stop() {
+    if (!file) return;
+    recording.store(false, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    writer.join();
+    sf_close(file);
+    file = nullptr;
+}
+
+void WavRecorder::write(const float* data, size_t n) {
+    size_t written = ring.push(data, n);
+    if (written < n) dropped.fetch_add(n - written, std::memory_order_relaxed);
+}
+
+void WavRecorder::run() {
+    std::unique_lock<std::mutex> lock(wake_mutex);
+    while (!stopping) {
+        wake.wait_for(lock, std::chrono::milliseconds(flush_ms.load()));
+        lock.unlock();
+        drain();
+        lock.lock();
+    }
+    lock.unlock();
+    drain();
+}
+
+void WavRecorder::drain() {
+    size_t n;
+    while ((n = ring.pop(batch.data(), batch.size())) > 0) {
+        sf_write_float(file, batch.data(), n);
+    }
+}
@@ -0,0 +1,46 @@
+#ifndef RECORDER_H
+#define RECORDER_H
+
+#include <sndfile.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "ring_buffer.h"
+
+// Records a mono float stream to a WAV file without doing any I/O on the
+// audio thread. write() only copies into a preallocated SPSC ring; a
+// background thread wakes every flush interval and hands whatever has
+// accumulated to libsndfile in one batch.
+class WavRecorder {
+public:
+    explicit WavRecorder(size_t capacity = 1 << 20, int flush_ms = 100);
+    ~WavRecorder();
+
+    // GUI thread.
+    bool start(const char* path, int samplerate);
+    void stop();
+    void setFlushInterval(int ms) { flush_ms = ms; }
+    bool isRecording() const { return recording.load(std::memory_order_acquire); }
+    size_t droppedSamples() const { return dropped.load(std::memory_order_relaxed); }
+
+    // Audio thread. Never blocks and never makes a syscall.
+    void write(const float* data, size_t n);
+
+private:
+    void run();
+    void drain();
+
+    SpscRingBuffer<float> ring;
+    std::vector<float> batch;
+    std::atomic<bool> recording{false};
+    std::atomic<size_t> dropped{0};
+    std::atomic<int> flush_ms;
+    SNDFILE* file = nullptr;
+    std::thread writer;
+    std::mutex wake_mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+};
+
+#endif // RECORDER_H
@@ -0,0 +1,67 @@
+#include "resampler.h"
+#include "dsp_kernels.h"
+#include "fir_filter.h"
+#include <algorithm>
+
+std::vector<float> designResamplerPrototype(int factor) {
+    return designLowpassFir(OVERSAMPLE_TAPS * factor, OVERSAMPLE_CUTOFF / factor);
+}
+
+PolyphaseInterpolator::PolyphaseInterpolator(int factor)
+    : rate_factor(std::max(1, std::min(OVERSAMPLE_MAX, factor))), history(OVERSAMPLE_TAPS - 1, 0.0f) {
+    std::vector<float> h = designResamplerPrototype(rate_factor);
+    // Output phase p at low-rate time n is sum_k h[k * L + p] * x[n - k]; the
+    // gain of L makes up for the energy the zero stuffing would have removed.
+    branches.resize(rate_factor * OVERSAMPLE_TAPS);
+    for (int p = 0; p < rate_factor; p++)
+        for (int k = 0; k < OVERSAMPLE_TAPS; k++)
+            branches[p * OVERSAMPLE_TAPS + OVERSAMPLE_TAPS - 1 - k] = h[k * rate_factor + p] * rate_factor;
+}
+
+void PolyphaseInterpolator::process(const float* in, float* out, size_t n) {
+    if (rate_factor == 1) {
+        std::copy(in, in + n, out);
+        return;
+    }
+    const DspKernels& k = dspKernels();
+    const size_t keep = OVERSAMPLE_TAPS - 1;
+    float buf[OVERSAMPLE_TAPS - 1 + RESAMPLER_BLOCK];
+    float branch_out[RESAMPLER_BLOCK];
+    std::copy(history.begin(), history.end(), buf);
+    for (size_t i = 0; i < n; i += RESAMPLER_BLOCK) {
+        size_t m = std::min<size_t>(RESAMPLER_BLOCK, n - i);
+        std::copy(in + i, in + i + m, buf + keep);
+        float* dst = out + i * rate_factor;
+        for (int p = 0; p < rate_factor; p++) {
+            k.fir(branches.data() + p * OVERSAMPLE_TAPS, OVERSAMPLE_TAPS, buf, branch_out, m);
+            for (size_t j = 0; j < m; j++) dst[j * rate_factor + p] = branch_out[j];
+        }
+        std::copy(buf + m, buf + m + keep, buf);
+    }
+    std::copy(buf, buf + keep, history.begin());
+}
+
+PolyphaseDecimator::PolyphaseDecimator(int factor)
+    : rate_factor(std::max(1, std::min(OVERSAMPLE_MAX, factor))), taps(designResamplerPrototype(rate_factor)) {
+    std::reverse(taps.begin(), taps.end());
+    history.assign(taps.size() - 1, 0.0f);
+}
+
+void PolyphaseDecimator::process(const float* in, float* out, size_t n) {
+    if (rate_factor == 1) {
+        std::copy(in, in + n, out);
+        return;
+    }
+    const DspKernels& k = dspKernels();
+    const size_t keep = history.size();
+    float buf[OVERSAMPLE_TAPS * OVERSAMPLE_MAX - 1 + RESAMPLER_BLOCK * OVERSAMPLE_MAX];
+    std::copy(history.begin(), history.end(), buf);
+    for (size_t i = 0; i < n; i += RESAMPLER_BLOCK) {
+        size_t m = std::min<size_t>(RESAMPLER_BLOCK, n - i);
+        size_t high = m * rate_factor;
+        std::copy(in + i * rate_factor, in + i * rate_factor + high, buf + keep);
+        k.firDecimate(taps.data(), taps.size(), buf, rate_factor, out + i, m);
+        std::copy(buf + high, buf + high + keep, buf);
+    }
+    std::copy(buf, buf + keep, history.begin());
+}
@@ -0,0 +1,51 @@
+#ifndef RESAMPLER_H
+#define RESAMPLER_H
+
+#include <cstddef>
+#include <vector>
+
+#define OVERSAMPLE_MAX 8
+#define OVERSAMPLE_TAPS 24 // prototype taps per polyphase branch
+#define OVERSAMPLE_CUTOFF 0.36 // passband edge as a fraction of the low rate (16 kHz at 44.1 kHz)
+#define RESAMPLER_BLOCK 256 // low-rate samples per kernel pass
+
+// Blackman-windowed sinc lowpass for changing the rate by `factor`:
+// OVERSAMPLE_TAPS * factor taps at the high rate, unit DC gain.
+std::vector<float> designResamplerPrototype(int factor);
+
+// Raises the sample rate by an integer factor. Branch p of the polyphase
+// filter produces output phase p from the low-rate input directly, so no
+// multiplies are spent on the zeros of a zero-stuffed signal.
+class PolyphaseInterpolator {
+public:
+    explicit PolyphaseInterpolator(int factor = 1);
+
+    int factor() const { return rate_factor; }
+
+    // n input samples in, n * factor() out.
+    void process(const float* in, float* out, size_t n);
+
+private:
+    int rate_factor;
+    std::vector<float> branches; // rate_factor branches of OVERSAMPLE_TAPS taps, reverse time order
+    std::vector<float> history;  // last OVERSAMPLE_TAPS - 1 inputs
+};
+
+// Lowers the sample rate by an integer factor, computing only the outputs
+// that are kept.
+class PolyphaseDecimator {
+public:
+    explicit PolyphaseDecimator(int factor = 1);
+
+    int factor() const { return rate_factor; }
+
+    // n * factor() input samples in, n out.
+    void process(const float* in, float* out, size_t n);
+
+private:
+    int rate_factor;
+    std::vector<float> taps;    // prototype in reverse time order
+    std::vector<float> history; // last taps.size() - 1 inputs
+};
+
+#endif // RESAMPLER_H
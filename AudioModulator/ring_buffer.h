@@ -0,0 +1,69 @@
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+#define CACHE_LINE_SIZE 64
+
+// Wait-free single-producer/single-consumer ring buffer. One thread may push,
+// one other thread may pop; neither ever blocks. The capacity is rounded up to
+// a power of two so positions wrap with a mask, and the two indices live on
+// separate cache lines so producer and consumer do not false-share.
+template <typename T>
+class SpscRingBuffer {
+public:
+    explicit SpscRingBuffer(size_t capacity) {
+        size_t size = 1;
+        while (size < capacity) size <<= 1;
+        buffer.resize(size);
+        mask = size - 1;
+    }
+
+    size_t capacity() const { return buffer.size(); }
+
+    // Producer side. Copies as many of the n items as fit and returns that
+    // count; items that do not fit are dropped.
+    size_t push(const T* data, size_t n) {
+        size_t w = write_pos.load(std::memory_order_relaxed);
+        if (buffer.size() - (w - cached_read_pos) < n)
+            cached_read_pos = read_pos.load(std::memory_order_acquire);
+        n = std::min(n, buffer.size() - (w - cached_read_pos));
+        size_t first = std::min(n, buffer.size() - (w & mask));
+        std::copy(data, data + first, buffer.begin() + (w & mask));
+        std::copy(data + first, data + n, buffer.begin());
+        write_pos.store(w + n, std::memory_order_release);
+        return n;
+    }
+
+    // Consumer side. Copies up to n items out and returns how many were read.
+    size_t pop(T* data, size_t n) {
+        size_t r = read_pos.load(std::memory_order_relaxed);
+        if (cached_write_pos - r < n)
+            cached_write_pos = write_pos.load(std::memory_order_acquire);
+        n = std::min(n, cached_write_pos - r);
+        size_t first = std::min(n, buffer.size() - (r & mask));
+        std::copy(buffer.begin() + (r & mask), buffer.begin() + (r & mask) + first, data);
+        std::copy(buffer.begin(), buffer.begin() + (n - first), data + first);
+        read_pos.store(r + n, std::memory_order_release);
+        return n;
+    }
+
+    // Consumer side. Number of items ready to pop.
+    size_t available() const {
+        return write_pos.load(std::memory_order_acquire) - read_pos.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::vector<T> buffer;
+    size_t mask;
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> write_pos{0};
+    size_t cached_read_pos = 0; // producer's last view of read_pos
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> read_pos{0};
+    size_t cached_write_pos = 0; // consumer's last view of write_pos
+    char padding[CACHE_LINE_SIZE - sizeof(std::atomic<size_t>) - sizeof(size_t)];
+};
+
+#endif // RING_BUFFER_H
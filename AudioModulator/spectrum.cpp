@@ -0,0 +1,118 @@
+#include "spectrum.h"
+#include <algorithm>
+#include <cmath>
+
+SpectrumAnalyzer::SpectrumAnalyzer(double sample_rate, size_t fft_size) : sample_rate(sample_rate), fft_size(0) {
+    setFftSize(fft_size);
+}
+
+SpectrumAnalyzer::~SpectrumAnalyzer() {
+    for (auto& p : plans) {
+        fftw_destroy_plan(p.second.plan);
+        fftw_free(p.second.in);
+        fftw_free(p.second.out);
+    }
+}
+
+void SpectrumAnalyzer::setFftSize(size_t n) {
+    size_t size = SPECTRUM_MIN_FFT;
+    while (size < n && size < SPECTRUM_MAX_FFT) size <<= 1;
+    if (size == fft_size) return;
+    fft_size = size;
+    auto it = plans.find(size);
+    if (it == plans.end()) {
+        Plan p;
+        p.in = (double*)fftw_malloc(sizeof(double) * size);
+        p.out = (fftw_complex*)fftw_malloc(sizeof(fftw_complex) * (size / 2 + 1));
+        // FFTW_MEASURE overwrites the arrays while planning, which is fine
+        // here since nothing is in them yet.
+        p.plan = fftw_plan_dft_r2c_1d(static_cast<int>(size), p.in, p.out, FFTW_MEASURE);
+        it = plans.insert(std::make_pair(size, p)).first;
+    }
+    current = &it->second;
+    history.assign(size, 0.0f);
+    write_pos = 0;
+    filled = 0;
+    configure();
+}
+
+void SpectrumAnalyzer::setWindow(Window w) {
+    window_type = w;
+    configure();
+}
+
+void SpectrumAnalyzer::setOverlap(double fraction) {
+    overlap = std::min(std::max(fraction, 0.0), 0.9375);
+    configure();
+}
+
+void SpectrumAnalyzer::setAveraging(Averaging a, double f) {
+    averaging = a;
+    factor = f;
+    configure();
+}
+
+void SpectrumAnalyzer::configure() {
+    size_t n = fft_size;
+    window.resize(n);
+    window_gain = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        double x = 2.0 * M_PI * i / n; // periodic form, so overlapped frames sum flat
+        window[i] = window_type == Window::Hann ? 0.5 - 0.5 * cos(x) : 0.42 - 0.5 * cos(x) + 0.08 * cos(2 * x);
+        window_gain += window[i];
+    }
+    hop = std::max<size_t>(1, n - static_cast<size_t>(n * overlap + 0.5));
+    since_frame = 0;
+    have_frame = false;
+    power.assign(n / 2 + 1, 0.0);
+    magnitudes.assign(n / 2 + 1, 0.0);
+}
+
+size_t SpectrumAnalyzer::process() {
+    size_t mask = fft_size - 1;
+    size_t frames = 0;
+    while (true) {
+        // Pop straight into the history ring, stopping at the next hop boundary.
+        size_t want = std::min(hop - since_frame, fft_size - (write_pos & mask));
+        size_t got = input.pop(history.data() + (write_pos & mask), want);
+        if (got == 0) break;
+        write_pos += got;
+        since_frame += got;
+        filled = std::min(filled + got, fft_size);
+        if (since_frame == hop) {
+            since_frame = 0;
+            if (filled == fft_size) {
+                analyseFrame();
+                frames++;
+            }
+        }
+    }
+    if (frames > 0) {
+        double scale = 1.0 / window_gain;
+        for (size_t k = 0; k < power.size(); k++) magnitudes[k] = sqrt(power[k]) * scale;
+    }
+    return frames;
+}
+
+void SpectrumAnalyzer::analyseFrame() {
+    size_t n = fft_size, mask = n - 1;
+    size_t start = write_pos & mask; // oldest sample
+    double* in = current->in;
+    for (size_t i = 0; i < n; i++) in[i] = history[(start + i) & mask] * window[i];
+    fftw_execute(current->plan);
+    const fftw_complex* out = current->out;
+    for (size_t k = 0; k < power.size(); k++) {
+        double p = out[k][0] * out[k][0] + out[k][1] * out[k][1];
+        if (!have_frame || averaging == Averaging::None)
+            power[k] = p;
+        else if (averaging == Averaging::Exponential)
+            power[k] += factor * (p - power[k]);
+        else
+            power[k] = std::max(p, power[k] * factor);
+    }
+    have_frame = true;
+}
+
+bool SpectrumAnalyzer::loadWisdom(const char* path) { return fftw_import_wisdom_from_filename(path) != 0; }
+
+bool SpectrumAnalyzer::saveWisdom(const char* path) { return fftw_export_wisdom_to_filename(path) != 0; }
@@ -0,0 +1,78 @@
+#ifndef SPECTRUM_H
+#define SPECTRUM_H
+
+#include <fftw3.h>
+#include <map>
+#include <vector>
+#include "ring_buffer.h"
+
+#define SPECTRUM_MIN_FFT 256
+#define SPECTRUM_MAX_FFT 65536
+
+enum class Window { Hann, Blackman };
+enum class Averaging { None, Exponential, Peak };
+
+// Streaming short-time Fourier transform. The audio thread pushes samples into
+// a wait-free ring; the consumer thread drains it in process(), running one
+// windowed FFT every hop (fft_size * (1 - overlap) samples) and folding each
+// frame into the averaged spectrum. Plans are made with FFTW_MEASURE, kept per
+// size, and can be reused across runs through the FFTW wisdom file.
+class SpectrumAnalyzer {
+public:
+    SpectrumAnalyzer(double sample_rate, size_t fft_size = 4096);
+    ~SpectrumAnalyzer();
+
+    // Producer (audio thread). Samples that do not fit are dropped.
+    void push(const float* data, size_t n) { input.push(data, n); }
+
+    // Consumer side. Changing a setting restarts the averages.
+    void setFftSize(size_t n); // rounded up to a power of two in [SPECTRUM_MIN_FFT, SPECTRUM_MAX_FFT]
+    void setWindow(Window w);
+    void setOverlap(double fraction); // 0 to 0.9375
+    // Exponential: weight of each new frame. Peak: per-frame decay of the held maximum.
+    void setAveraging(Averaging a, double factor);
+
+    // Analyse everything pushed so far; returns the number of frames run.
+    size_t process();
+
+    size_t fftSize() const { return fft_size; }
+    size_t bins() const { return fft_size / 2 + 1; }
+    double binFrequency(size_t bin) const { return bin * sample_rate / fft_size; }
+    // Averaged amplitude per bin, scaled so a full-scale sine reads 0.5.
+    const std::vector<double>& magnitude() const { return magnitudes; }
+
+    static bool loadWisdom(const char* path);
+    static bool saveWisdom(const char* path);
+
+private:
+    struct Plan {
+        fftw_plan plan;
+        double* in;
+        fftw_complex* out;
+    };
+
+    void configure();
+    void analyseFrame();
+
+    SpscRingBuffer<float> input{2 * SPECTRUM_MAX_FFT};
+    double sample_rate;
+    size_t fft_size;
+    Window window_type = Window::Hann;
+    double overlap = 0.75;
+    Averaging averaging = Averaging::Exponential;
+    double factor = 0.25;
+
+    std::map<size_t, Plan> plans;
+    Plan* current = nullptr;
+    std::vector<double> window;
+    double window_gain = 1.0;   // sum of the window, for amplitude scaling
+    std::vector<float> history; // circular, fft_size samples
+    size_t write_pos = 0;
+    size_t filled = 0;          // samples in history, up to fft_size
+    size_t hop = 0;
+    size_t since_frame = 0;
+    bool have_frame = false;
+    std::vector<double> power, magnitudes;
+};
+
+#endif // SPECTRUM_H
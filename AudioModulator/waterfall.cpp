@@ -0,0 +1,32 @@
+#include "waterfall.h"
+#include <algorithm>
+#include <cmath>
+
+Waterfall::Waterfall(QCustomPlot* plot, double row_seconds) : plot(plot), row(WATERFALL_COLUMNS) {
+    map = new QCPColorMap(plot->xAxis, plot->yAxis);
+    map->data()->setSize(WATERFALL_COLUMNS, WATERFALL_ROWS);
+    map->data()->setRange(QCPRange(0, 1), QCPRange(-(WATERFALL_ROWS - 1) * row_seconds, 0));
+    map->data()->fill(WATERFALL_FLOOR_DB);
+    map->setGradient(QCPColorGradient::gpJet);
+    map->setDataRange(QCPRange(WATERFALL_FLOOR_DB, 0));
+    map->setInterpolate(false);
+    plot->yAxis->setLabel("Time (s)");
+    plot->yAxis->setRange(map->data()->valueRange());
+}
+
+void Waterfall::addSpectrum(const std::vector<double>& magnitude, double max_freq) {
+    size_t bins = magnitude.size();
+    if (bins == 0) return;
+    if (map->data()->keyRange().upper != max_freq) {
+        map->data()->setKeyRange(QCPRange(0, max_freq));
+        plot->xAxis->setRange(0, max_freq);
+    }
+    // Each column takes the loudest bin it covers, so narrow tones survive decimation.
+    for (size_t c = 0; c < WATERFALL_COLUMNS; c++) {
+        size_t first = c * bins / WATERFALL_COLUMNS;
+        size_t last = std::max(first + 1, (c + 1) * bins / WATERFALL_COLUMNS);
+        double peak = *std::max_element(magnitude.begin() + first, magnitude.begin() + last);
+        row[c] = std::max(20.0 * log10(peak + 1e-12), WATERFALL_FLOOR_DB);
+    }
+    map->data()->appendValueRow(row.data());
+}
@@ -0,0 +1,28 @@
+#ifndef WATERFALL_H
+#define WATERFALL_H
+
+#include <vector>
+#include "qcustomplot.h"
+
+#define WATERFALL_COLUMNS 1024 // frequency cells; larger spectra are peak-decimated
+#define WATERFALL_ROWS 1000
+#define WATERFALL_FLOOR_DB -100.0
+
+// Scrolling spectrogram on a QCPColorMap: frequency across, newest spectrum
+// on top. Spectra enter through QCPColorMapData::appendValueRow, so the map
+// storage is a ring of rows and a replot only colorizes the rows added since
+// the last one.
+class Waterfall {
+public:
+    Waterfall(QCustomPlot* plot, double row_seconds);
+
+    // Add one spectrum (amplitude per bin, bins spanning 0 to max_freq) as the newest row.
+    void addSpectrum(const std::vector<double>& magnitude, double max_freq);
+
+private:
+    QCustomPlot* plot;
+    QCPColorMap* map;
+    std::vector<double> row;
+};
+
+#endif // WATERFALL_H